@@ -8,24 +8,17 @@
 #ifndef UNSAFE_BIND_HPP
 #define UNSAFE_BIND_HPP
 
+#include <cstddef> // offsetof
 #include <utility>
 #include <type_traits>
 
 namespace unsafe
 {
-    // https://en.cppreference.com/w/cpp/types/is_function
-    template<typename F> struct mem_fn_t;
-    template<typename R, class C, typename... A>
-    struct mem_fn_t<R(C::*)(A...)>
+    // What mem_fn_t knows about the parameters, shared by all member pointers taking A...
+    template<typename... A>
+    struct mem_fn_args
     {
-        using ret = R;
-        using cls = C;
-        using obj = C&;
-        using type = R(A...);
-        static const bool var = false;
-        static const bool noe = false;
         static const std::size_t argc = sizeof...(A);
-        template<typename T> using cvr = T;
         template<typename T> struct id { using type = T; };
         template<template<typename...> class S, template<typename> class T = id>
         using args = S<typename T<A>::type...>;
@@ -35,7 +28,23 @@ namespace unsafe
         static const auto argv = args<S, T>::value;
     };
 
-    template<typename R, class C> struct mem_fn_t<R C::*> : mem_fn_t<R(C::*)()> { using type = R; };
+    // https://en.cppreference.com/w/cpp/types/is_function
+    // Each member pointer type matches one specialization, which spells out all of its
+    // members rather than deriving from a less qualified one, so that a query
+    // instantiates mem_fn_t once plus mem_fn_args once per parameter list.
+    template<typename F> struct mem_fn_t;
+
+    template<typename R, class C>
+    struct mem_fn_t<R C::*> : mem_fn_args<>
+    {
+        using ret = R;
+        using cls = C;
+        using obj = C&;
+        using type = R;
+        static const bool var = false;
+        static const bool noe = false;
+        template<typename T> using cvr = T;
+    };
 
     #if _MSC_VER < 1930 || defined(__clang__)
     // Before Visual Studio 2022, the comma is required.
@@ -45,40 +54,43 @@ namespace unsafe
     #define VARIADIC_TEMPLATE_C_VARIADIC_ELLIPSIS ...
     #endif
 
-    #define MEM_FN_T_C_Q(Q, E) \
-    template<typename R, class C, typename... A> \
-    struct mem_fn_t<R(C::*)(A... VARIADIC_TEMPLATE_C_VARIADIC_ELLIPSIS) Q E> : \
-    mem_fn_t<R(C::*)(A...) Q E> { static const bool var = true; \
-    using type = R(A... VARIADIC_TEMPLATE_C_VARIADIC_ELLIPSIS) Q E; }; \
+    #define MEM_FN_T_E
 
-    #define MEM_FN_T_Q(Q, E) MEM_FN_T_C_Q(Q, E) \
+    #define MEM_FN_T_S(V, EL, Q, O, N, E) \
     template<typename R, class C, typename... A> \
-    struct mem_fn_t<R(C::*)(A...) Q E> : mem_fn_t<R(C::*)(A...) E> { template<typename T> using cvr = T Q; \
-    using obj = std::conditional_t<std::is_reference_v<C Q>, C Q, std::add_lvalue_reference_t<C Q>>; \
-    using type = R(A...) Q E; }; \
+    struct mem_fn_t<R(C::*)(A... EL) Q E> : mem_fn_args<A...> { \
+    using ret = R; using cls = C; using obj = C O; using type = R(A... EL) Q E; \
+    static const bool var = V; static const bool noe = N; \
+    template<typename T> using cvr = T Q; }; \
 
-    #define MEM_FN_T(E) MEM_FN_T_Q(&, E) MEM_FN_T_Q(&&, E) \
-    MEM_FN_T_Q(const, E) MEM_FN_T_Q(const&, E) MEM_FN_T_Q(const&&, E) \
-    MEM_FN_T_Q(volatile, E) MEM_FN_T_Q(volatile&, E) MEM_FN_T_Q(volatile&&, E) \
-    MEM_FN_T_Q(const volatile, E) MEM_FN_T_Q(const volatile&, E) MEM_FN_T_Q(const volatile&&, E) \
+    #define MEM_FN_T_Q(Q, O, N, E) MEM_FN_T_S(false, MEM_FN_T_E, Q, O, N, E) \
+    MEM_FN_T_S(true, VARIADIC_TEMPLATE_C_VARIADIC_ELLIPSIS, Q, O, N, E) \
+
+    #define MEM_FN_T(N, E) MEM_FN_T_Q(MEM_FN_T_E, &, N, E) MEM_FN_T_Q(&, &, N, E) MEM_FN_T_Q(&&, &&, N, E) \
+    MEM_FN_T_Q(const, const&, N, E) MEM_FN_T_Q(const&, const&, N, E) MEM_FN_T_Q(const&&, const&&, N, E) \
+    MEM_FN_T_Q(volatile, volatile&, N, E) MEM_FN_T_Q(volatile&, volatile&, N, E) MEM_FN_T_Q(volatile&&, volatile&&, N, E) \
+    MEM_FN_T_Q(const volatile, const volatile&, N, E) MEM_FN_T_Q(const volatile&, const volatile&, N, E) \
+    MEM_FN_T_Q(const volatile&&, const volatile&&, N, E) \
 
     #ifdef __cpp_noexcept_function_type
-    template<typename R, class C, typename... A>
-    struct mem_fn_t<R(C::*)(A...) noexcept> : mem_fn_t<R(C::*)(A...)> { static const bool noe = true;
-    using type = R(A...) noexcept; };
-    MEM_FN_T(noexcept)
+    MEM_FN_T(true, noexcept)
     #endif
-    #define MEM_FN_T_E
-    MEM_FN_T(MEM_FN_T_E)
-    MEM_FN_T_C_Q(MEM_FN_T_E, MEM_FN_T_E)
+    MEM_FN_T(false, MEM_FN_T_E)
 
 
     template<int i> struct tag {};
-   
+
+    template<int i, typename PM, PM pm> struct bind;
+
+    // Finds the member pointer bound to i for the class of self or one of its bases.
+    // Each binding declares a single pointer_of overload, and every call resolves
+    // against all of them, so one per binding rather than one per value category.
     template<int i, class Self>
     decltype(auto) get(Self&& self) noexcept
     {
-        return get(std::forward<Self>(self), tag<i>{});
+        using C = std::remove_cv_t<std::remove_reference_t<Self>>;
+        using PM = decltype(pointer_of(static_cast<C*>(nullptr), tag<i>{}));
+        return bind<i, PM, pointer_of(static_cast<C*>(nullptr), tag<i>{})>::get(std::forward<Self>(self));
     }
 
     // https://en.cppreference.com/w/cpp/language/class_template
@@ -97,19 +109,110 @@ namespace unsafe
                 return std::forward<Self>(self).*pm;
         }
 
-        [[maybe_unused]] friend decltype(auto) get(typename mem_fn_t<PM>::cls& self, tag<i>) { return get(self); }
-        [[maybe_unused]] friend decltype(auto) get(typename mem_fn_t<PM>::cls&& self, tag<i>) { return get(std::move(self)); }
-        [[maybe_unused]] friend decltype(auto) get(typename mem_fn_t<PM>::cls const& self, tag<i>) { return get(self); }
+        [[maybe_unused]] friend constexpr auto pointer_of(typename mem_fn_t<PM>::cls*, tag<i>) { return pm; }
+    };
+
+    // The raw pointer to member i of C, usable in constant expressions.
+    template<class C, int i>
+    inline constexpr auto member_pointer = pointer_of(static_cast<C*>(nullptr), tag<i>{});
+
+    // The member function pm as a plain function taking the object first, with the
+    // cv and ref qualifiers of pm on the object and its noexcept. Unlike the lambda
+    // of get, it can be stored, passed as a function pointer or a template argument.
+    template<auto pm>
+    struct invoker
+    {
+        using traits = mem_fn_t<decltype(pm)>;
+        static_assert(std::is_member_function_pointer_v<decltype(pm)> && !traits::var,
+                      "pm must point to a non-variadic member function");
+
+        template<typename... A>
+        struct with
+        {
+            static typename traits::ret call(typename traits::obj self, A... args) noexcept(traits::noe)
+            {
+                return (static_cast<typename traits::obj>(self).*pm)(static_cast<A&&>(args)...);
+            }
+        };
+
+        static constexpr auto function = &traits::template args<with>::call;
+    };
+
+    template<class C, int i>
+    inline constexpr auto member_function = invoker<member_pointer<C, i>>::function;
+
+    // A data member bound together with its offset, which offsetof computes in the
+    // explicit instantiation where the member is accessible. Declared by UNSAFE_FIELDS.
+    template<int i, typename PM, PM pm, std::size_t off>
+    struct field : bind<i, PM, pm>
+    {
+        using class_type = typename mem_fn_t<PM>::cls;
+        using type = typename mem_fn_t<PM>::type;
+        static constexpr int index = i;
+        static constexpr PM pointer = pm;
+        static constexpr std::size_t offset = off;
+        static constexpr std::size_t size = sizeof(type);
+
+        [[maybe_unused]] friend constexpr auto field_of(class_type*, tag<i>) { return field{}; }
     };
+
+    // The number of fields of C listed by UNSAFE_FIELDS, and field_t<C, i> the i-th.
+    template<class C> struct fields;
+
+    template<class C, int i>
+    using field_t = decltype(field_of(static_cast<C*>(nullptr), tag<i>{}));
 }
 
 #define UNSAFE_BIND_T(C, i, m, T) namespace unsafe { \
 template struct bind<i, T, &C::m>; \
-decltype(auto) get(C&, tag<i>); \
-decltype(auto) get(C&&, tag<i>); \
-decltype(auto) get(C const&, tag<i>); \
+constexpr auto pointer_of(C*, tag<i>); \
 }
 
 #define UNSAFE_BIND(C, i, m) UNSAFE_BIND_T(C, i, m, decltype(&C::m))
 
+// offsetof on a class that is not standard-layout, e.g. mixing public and private
+// members, is conditionally-supported. Main compilers support it without virtual bases.
+#if defined(__GNUC__)
+#define UNSAFE_OFFSETOF_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define UNSAFE_OFFSETOF_END _Pragma("GCC diagnostic pop")
+#else
+#define UNSAFE_OFFSETOF_BEGIN
+#define UNSAFE_OFFSETOF_END
+#endif
+
+#define UNSAFE_FIELD(C, i, m) UNSAFE_OFFSETOF_BEGIN namespace unsafe { \
+template struct field<i, decltype(&C::m), &C::m, offsetof(C, m)>; \
+constexpr auto pointer_of(C*, tag<i>); \
+constexpr auto field_of(C*, tag<i>); \
+} UNSAFE_OFFSETOF_END
+
+#define UNSAFE_EXPAND(x) x
+#define UNSAFE_CAT(a, b) UNSAFE_CAT_(a, b)
+#define UNSAFE_CAT_(a, b) a##b
+#define UNSAFE_NARGS(...) UNSAFE_EXPAND(UNSAFE_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define UNSAFE_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+
+#define UNSAFE_FIELDS_1(C, i, m) UNSAFE_FIELD(C, i, m)
+#define UNSAFE_FIELDS_2(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_1(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_3(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_2(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_4(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_3(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_5(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_4(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_6(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_5(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_7(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_6(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_8(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_7(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_9(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_8(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_10(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_9(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_11(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_10(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_12(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_11(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_13(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_12(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_14(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_13(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_15(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_14(C, i + 1, __VA_ARGS__))
+#define UNSAFE_FIELDS_16(C, i, m, ...) UNSAFE_FIELD(C, i, m) UNSAFE_EXPAND(UNSAFE_FIELDS_15(C, i + 1, __VA_ARGS__))
+
+// Binds the data members of C in declaration order to the indices 0, 1, ..., up to 16,
+// so that unsafe::get<i>(obj) is the i-th member and field_t<C, i> describes it.
+#define UNSAFE_FIELDS(C, ...) \
+UNSAFE_EXPAND(UNSAFE_CAT(UNSAFE_FIELDS_, UNSAFE_NARGS(__VA_ARGS__))(C, 0, __VA_ARGS__)) \
+namespace unsafe { template<> struct fields<C> { static constexpr int count = UNSAFE_NARGS(__VA_ARGS__); }; }
+
 #endif
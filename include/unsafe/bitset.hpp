@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_BITSET_HPP
+#define UNSAFE_BITSET_HPP
+
+#include <bitset>
+#include <climits> // CHAR_BIT
+#include <type_traits>
+#include <version>
+#ifdef __cpp_lib_bitops
+#include <bit>
+#endif
+
+#include "vector.hpp"
+
+namespace unsafe
+{
+    // std::bitset stores its words at the beginning of the object, bit i being
+    // bit i % word_bits of word i / word_bits. The bits past N are kept zero.
+    template<std::size_t N>
+    union bitset
+    {
+        std::bitset<N> b;
+
+#if defined(_MSVC_STL_UPDATE)
+        // https://github.com/microsoft/STL/blob/vs-2022-17.9/stl/inc/bitset#L539-L542
+        using word_type = std::conditional_t<N <= sizeof(unsigned long) * CHAR_BIT, unsigned long, unsigned long long>;
+#elif defined(__GLIBCXX__)
+        // https://github.com/gcc-mirror/gcc/blob/releases/gcc-13.2.0/libstdc++-v3/include/std/bitset#L78-L80
+        using word_type = unsigned long;
+#elif defined(_LIBCPP_VERSION)
+        // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/include/bitset#L158-L166
+        using word_type = std::size_t;
+#else
+        using word_type = unsigned long;
+#endif
+
+        static constexpr std::size_t word_bits = sizeof(word_type) * CHAR_BIT;
+        static constexpr std::size_t word_count = (N + word_bits - 1) / word_bits;
+        static_assert(sizeof(std::bitset<N>) >= sizeof(word_type) * word_count);
+
+        ~bitset() {}
+        operator std::bitset<N>&() noexcept { return b; }
+
+        word_type* words() noexcept { return reinterpret_cast<word_type*>(&b); }
+        static constexpr std::size_t size() noexcept { return N; }
+    };
+
+    template<std::size_t N>
+    auto words(std::bitset<N>& b) noexcept
+    {
+        return reinterpret_cast<bitset<N>&>(b).words();
+    }
+
+    template<std::size_t N>
+    auto words(const std::bitset<N>& b) noexcept
+    {
+        return const_cast<const typename bitset<N>::word_type*>(
+            reinterpret_cast<bitset<N>&>(const_cast<std::bitset<N>&>(b)).words());
+    }
+
+    template<typename W>
+    int word_popcount(W w) noexcept
+    {
+        static_assert(std::is_unsigned_v<W> && sizeof(W) <= sizeof(unsigned long long));
+#if defined(__cpp_lib_bitops)
+        return std::popcount(w);
+#elif defined(__GNUC__)
+        return __builtin_popcountll(w);
+#else
+        return static_cast<int>(std::bitset<sizeof(W) * CHAR_BIT>(w).count());
+#endif
+    }
+
+    // w must not be zero.
+    template<typename W>
+    int word_countr_zero(W w) noexcept
+    {
+        static_assert(std::is_unsigned_v<W> && sizeof(W) <= sizeof(unsigned long long));
+#if defined(__cpp_lib_bitops)
+        return std::countr_zero(w);
+#elif defined(__GNUC__)
+        return __builtin_ctzll(w);
+#else
+        int n = 0;
+        for (; !(w & 1); w >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    // The word loops below have no cross-word dependencies, so compilers vectorize
+    // them given a target with vector popcount (e.g. -mavx512vpopcntdq) or plain SIMD.
+
+    // Number of set bits among the first n bits of words.
+    template<typename W>
+    std::size_t popcount(const W* words, std::size_t n) noexcept
+    {
+        constexpr std::size_t bits = sizeof(W) * CHAR_BIT;
+        const std::size_t full = n / bits;
+
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < full; ++i)
+            count += word_popcount(words[i]);
+        if (n % bits)
+            count += word_popcount(W(words[full] & (W(~W()) >> (bits - n % bits))));
+        return count;
+    }
+
+    // Index of the first set bit at or after pos among the first n bits of words, or n.
+    template<typename W>
+    std::size_t find_first(const W* words, std::size_t n, std::size_t pos = 0) noexcept
+    {
+        constexpr std::size_t bits = sizeof(W) * CHAR_BIT;
+        if (pos >= n) return n;
+
+        const std::size_t count = (n + bits - 1) / bits;
+        std::size_t i = pos / bits;
+        W w = words[i] & W(W(~W()) << pos % bits);
+        while (w == 0 && ++i < count) w = words[i];
+        if (i == count) return n;
+
+        const std::size_t r = i * bits + word_countr_zero(w);
+        return r < n ? r : n;
+    }
+
+    // Sets the first n bits of dst to op(a, b) applied word by word, e.g. with
+    // std::bit_and<>. The other bits of dst are preserved. dst may alias a or b.
+    template<typename W, class Op>
+    void combine(W* dst, const W* a, const W* b, std::size_t n, Op op)
+    {
+        constexpr std::size_t bits = sizeof(W) * CHAR_BIT;
+        const std::size_t full = n / bits;
+
+        for (std::size_t i = 0; i < full; ++i)
+            dst[i] = op(a[i], b[i]);
+        if (n % bits)
+        {
+            const W mask = W(~W()) >> (bits - n % bits);
+            dst[full] = W((dst[full] & ~mask) | (op(a[full], b[full]) & mask));
+        }
+    }
+
+    template<class A>
+    std::size_t popcount(const std::vector<bool, A>& v) noexcept
+    {
+        return popcount(words(v), v.size());
+    }
+
+    template<std::size_t N>
+    std::size_t popcount(const std::bitset<N>& b) noexcept
+    {
+        return popcount(words(b), N);
+    }
+
+    template<class A>
+    std::size_t find_first(const std::vector<bool, A>& v, std::size_t pos = 0) noexcept
+    {
+        return find_first(words(v), v.size(), pos);
+    }
+
+    template<std::size_t N>
+    std::size_t find_first(const std::bitset<N>& b, std::size_t pos = 0) noexcept
+    {
+        return find_first(words(b), N, pos);
+    }
+
+    // Combines the first a.size() bits; dst and b must have at least as many.
+    template<class A1, class A2, class A3, class Op>
+    void combine(std::vector<bool, A1>& dst, const std::vector<bool, A2>& a, const std::vector<bool, A3>& b, Op op)
+    {
+        combine(words(dst), words(a), words(b), a.size(), op);
+    }
+
+    template<std::size_t N, class Op>
+    void combine(std::bitset<N>& dst, const std::bitset<N>& a, const std::bitset<N>& b, Op op)
+    {
+        combine(words(dst), words(a), words(b), N, op);
+    }
+}
+
+#endif
@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_COLUMNS_HPP
+#define UNSAFE_COLUMNS_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include "bind.hpp"
+
+namespace unsafe
+{
+    // The type of member i of C bound by UNSAFE_BIND or UNSAFE_FIELDS.
+    template<class C, int i>
+    using member_t = std::remove_reference_t<decltype(get<i>(std::declval<C&>()))>;
+
+    // A member of consecutive objects seen in place as a sequence, stride bytes apart.
+    template<typename T>
+    class strided_view
+    {
+        using byte = std::conditional_t<std::is_const_v<T>, const char, char>;
+        byte* base = nullptr;
+        std::ptrdiff_t stride = 0;
+        std::size_t n = 0;
+
+    public:
+        class iterator
+        {
+            byte* p = nullptr;
+            std::ptrdiff_t stride = 0;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::remove_cv_t<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+
+            iterator() noexcept = default;
+            iterator(byte* p, std::ptrdiff_t stride) noexcept : p(p), stride(stride) {}
+
+            T& operator*() const noexcept { return *reinterpret_cast<T*>(p); }
+            T* operator->() const noexcept { return reinterpret_cast<T*>(p); }
+            T& operator[](std::ptrdiff_t k) const noexcept { return *reinterpret_cast<T*>(p + k * stride); }
+
+            iterator& operator++() noexcept { p += stride; return *this; }
+            iterator& operator--() noexcept { p -= stride; return *this; }
+            iterator operator++(int) noexcept { iterator t = *this; p += stride; return t; }
+            iterator operator--(int) noexcept { iterator t = *this; p -= stride; return t; }
+            iterator& operator+=(std::ptrdiff_t k) noexcept { p += k * stride; return *this; }
+            iterator& operator-=(std::ptrdiff_t k) noexcept { p -= k * stride; return *this; }
+            friend iterator operator+(iterator i, std::ptrdiff_t k) noexcept { return i += k; }
+            friend iterator operator+(std::ptrdiff_t k, iterator i) noexcept { return i += k; }
+            friend iterator operator-(iterator i, std::ptrdiff_t k) noexcept { return i -= k; }
+            friend std::ptrdiff_t operator-(iterator a, iterator b) noexcept { return (a.p - b.p) / a.stride; }
+
+            friend bool operator==(iterator a, iterator b) noexcept { return a.p == b.p; }
+            friend bool operator!=(iterator a, iterator b) noexcept { return a.p != b.p; }
+            friend bool operator<(iterator a, iterator b) noexcept { return a.p < b.p; }
+            friend bool operator>(iterator a, iterator b) noexcept { return a.p > b.p; }
+            friend bool operator<=(iterator a, iterator b) noexcept { return a.p <= b.p; }
+            friend bool operator>=(iterator a, iterator b) noexcept { return a.p >= b.p; }
+        };
+
+        strided_view() noexcept = default;
+        strided_view(T* first, std::ptrdiff_t stride, std::size_t n) noexcept
+            : base(reinterpret_cast<byte*>(first)), stride(stride), n(n) {}
+
+        std::size_t size() const noexcept { return n; }
+        bool empty() const noexcept { return n == 0; }
+        std::ptrdiff_t stride_bytes() const noexcept { return stride; }
+        T& operator[](std::size_t k) const noexcept { return *reinterpret_cast<T*>(base + k * stride); }
+        iterator begin() const noexcept { return { base, stride }; }
+        iterator end() const noexcept { return { base + n * stride, stride }; }
+    };
+
+    // Member i of the n objects at first, in place.
+    template<int i, class C>
+    strided_view<member_t<C, i>> column_view(C* first, std::size_t n) noexcept
+    {
+        if (n == 0) return {};
+        return { &get<i>(*first), static_cast<std::ptrdiff_t>(sizeof(C)), n };
+    }
+
+    template<int i, class C, class A>
+    strided_view<member_t<C, i>> column_view(std::vector<C, A>& v) noexcept
+    {
+        return column_view<i>(v.data(), v.size());
+    }
+
+    template<int i, class C, class A>
+    strided_view<member_t<const C, i>> column_view(const std::vector<C, A>& v) noexcept
+    {
+        return column_view<i>(v.data(), v.size());
+    }
+
+    // Members I... of the n objects at first copied into one contiguous array each,
+    // where loops over a single member vectorize.
+    template<int... I, class C>
+    std::tuple<std::vector<std::remove_cv_t<member_t<C, I>>>...> transpose(const C* first, std::size_t n)
+    {
+        std::tuple<std::vector<std::remove_cv_t<member_t<C, I>>>...> columns;
+        std::apply([&](auto&... column) {
+            (column.resize(n), ...);
+            for (std::size_t k = 0; k < n; ++k)
+                ((column[k] = get<I>(first[k])), ...);
+        }, columns);
+        return columns;
+    }
+
+    template<int... I, class C, class A>
+    auto transpose(const std::vector<C, A>& v)
+    {
+        return transpose<I...>(v.data(), v.size());
+    }
+
+    // Copies the columns of transpose back into members I... of the objects at first.
+    template<int... I, class C, typename... T>
+    void write_back(const std::tuple<std::vector<T>...>& columns, C* first)
+    {
+        static_assert(sizeof...(I) > 0 && sizeof...(I) == sizeof...(T), "one column per member");
+        const std::size_t n = std::get<0>(columns).size();
+        std::apply([&](const auto&... column) {
+            for (std::size_t k = 0; k < n; ++k)
+                ((get<I>(first[k]) = column[k]), ...);
+        }, columns);
+    }
+
+    template<int... I, class C, class A, typename... T>
+    void write_back(const std::tuple<std::vector<T>...>& columns, std::vector<C, A>& v)
+    {
+        write_back<I...>(columns, v.data());
+    }
+}
+
+#endif
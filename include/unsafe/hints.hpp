@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_HINTS_HPP
+#define UNSAFE_HINTS_HPP
+
+#include <cerrno>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h> // posix_fadvise, fallocate, sync_file_range, readahead
+#endif
+
+#include "iostream.hpp"
+
+namespace unsafe
+{
+    enum class access_advice
+    {
+#ifdef __linux__
+        normal = POSIX_FADV_NORMAL,
+        sequential = POSIX_FADV_SEQUENTIAL,
+        random = POSIX_FADV_RANDOM,
+        willneed = POSIX_FADV_WILLNEED,
+        dontneed = POSIX_FADV_DONTNEED,
+        noreuse = POSIX_FADV_NOREUSE,
+#else
+        normal, sequential, random, willneed, dontneed, noreuse,
+#endif
+    };
+
+    // {fd, offset} of the logical position of the stream in the file. Pending output is
+    // flushed first, and the characters buffered ahead by the filebuf are accounted for,
+    // so the offset is where the next character is read or written. The offset is -1
+    // for unseekable files; the fd is -1 for streams without a file descriptor.
+    template<class CharT, class Traits>
+    std::pair<int, std::streamoff> file_position(std::basic_ios<CharT, Traits>& stream, std::ios_base::openmode which)
+    {
+        std::basic_streambuf<CharT, Traits>* buf = stream.rdbuf();
+        const int fd = buf ? streambuf_fileno(buf) : -1;
+        if (fd < 0) return { -1, -1 };
+        buf->pubsync();
+        return { fd, std::streamoff(buf->pubseekoff(0, std::ios_base::cur, which)) };
+    }
+
+    // The functions below apply to the file offsets around the logical position of the
+    // stream. They return 0 on success or an errno value, ENOSYS where the platform has
+    // no such hint.
+
+    // posix_fadvise on len bytes from the logical position, up to the end of file if 0.
+    template<class CharT, class Traits>
+    int advise(std::basic_ios<CharT, Traits>& stream, access_advice advice, std::streamoff len = 0)
+    {
+        const auto [fd, pos] = file_position(stream, std::ios_base::in | std::ios_base::out);
+        if (fd < 0) return EBADF;
+#ifdef __linux__
+        return ::posix_fadvise(fd, pos < 0 ? 0 : pos, len, static_cast<int>(advice));
+#else
+        (void)pos; (void)advice; (void)len;
+        return ENOSYS;
+#endif
+    }
+
+    // Starts reading len bytes from the logical position into the page cache with
+    // readahead(2), without waiting for it.
+    template<class CharT, class Traits>
+    int readahead(std::basic_istream<CharT, Traits>& stream, std::streamoff len)
+    {
+        const auto [fd, pos] = file_position(stream, std::ios_base::in);
+        if (fd < 0) return EBADF;
+        if (pos < 0) return ESPIPE;
+#ifdef __linux__
+        return ::readahead(fd, pos, static_cast<std::size_t>(len)) == 0 ? 0 : errno;
+#else
+        (void)len;
+        return ENOSYS;
+#endif
+    }
+
+    // Reserves disk space for len bytes from the logical position so that appends do not
+    // fragment. The file size is unchanged, fallocate(2) with FALLOC_FL_KEEP_SIZE, so
+    // nothing is left behind if less is written.
+    template<class CharT, class Traits>
+    int preallocate(std::basic_ostream<CharT, Traits>& stream, std::streamoff len)
+    {
+        const auto [fd, pos] = file_position(stream, std::ios_base::out);
+        if (fd < 0) return EBADF;
+        if (pos < 0) return ESPIPE;
+#ifdef __linux__
+        return ::fallocate(fd, FALLOC_FL_KEEP_SIZE, pos, len) == 0 ? 0 : errno;
+#else
+        (void)len;
+        return ENOSYS;
+#endif
+    }
+
+    // Starts writeback of the written part of the file before the logical position,
+    // the last len bytes of it or all if len is 0, with sync_file_range(2). Pass
+    // SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER
+    // as flags to wait for it. No metadata is written, so this is no substitute for fsync.
+    template<class CharT, class Traits>
+    int writeback(std::basic_ostream<CharT, Traits>& stream, std::streamoff len = 0, unsigned flags =
+#ifdef __linux__
+        SYNC_FILE_RANGE_WRITE
+#else
+        0
+#endif
+    )
+    {
+        const auto [fd, pos] = file_position(stream, std::ios_base::out);
+        if (fd < 0) return EBADF;
+        if (pos < 0) return ESPIPE;
+#ifdef __linux__
+        const std::streamoff from = len == 0 || len > pos ? 0 : pos - len;
+        return ::sync_file_range(fd, from, pos - from, flags) == 0 ? 0 : errno;
+#else
+        (void)len; (void)flags;
+        return ENOSYS;
+#endif
+    }
+}
+
+#endif
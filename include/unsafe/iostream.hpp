@@ -10,13 +10,31 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm> // min
+#include <atomic>
+#include <cerrno>
+#include <climits> // INT_MAX
 #include <cstdio> // fileno
+#include <cstdint>
 #include <cstring> // strncmp
+#include <iterator> // size
+#include <limits>
+#include <tuple>
+#include <typeinfo>
 
 #ifdef _WIN32
 #include <io.h> // _get_osfhandle
 #endif
 
+#ifdef __linux__
+#include <fcntl.h> // splice
+#include <sys/sendfile.h> // sendfile
+#endif
+
+#ifndef _WIN32
+#include <unistd.h> // copy_file_range, lseek
+#endif
+
 #if defined(__GLIBCXX__)
 #include <ext/stdio_sync_filebuf.h>
 #endif
@@ -26,6 +44,16 @@
 #if defined(_LIBCPP_VERSION)
 UNSAFE_BIND(std::filebuf, ~0, __file_);
 UNSAFE_BIND(std::wfilebuf, ~0, __file_);
+UNSAFE_BIND(std::filebuf, ~1, __extbuf_);
+UNSAFE_BIND(std::wfilebuf, ~1, __extbuf_);
+UNSAFE_BIND(std::filebuf, ~2, __ebs_);
+UNSAFE_BIND(std::wfilebuf, ~2, __ebs_);
+UNSAFE_BIND(std::filebuf, ~3, __intbuf_);
+UNSAFE_BIND(std::wfilebuf, ~3, __intbuf_);
+UNSAFE_BIND(std::filebuf, ~4, __ibs_);
+UNSAFE_BIND(std::wfilebuf, ~4, __ibs_);
+UNSAFE_BIND(std::filebuf, ~5, __always_noconv_);
+UNSAFE_BIND(std::wfilebuf, ~5, __always_noconv_);
 #elif defined(_MSVC_STL_UPDATE)
 UNSAFE_BIND(std::filebuf, ~0, _Myfile);
 UNSAFE_BIND(std::wfilebuf, ~0, _Myfile);
@@ -33,6 +61,27 @@ UNSAFE_BIND(std::wfilebuf, ~0, _Myfile);
 
 namespace unsafe
 {
+    // Exposes the protected buffer management of any std::basic_streambuf.
+    template<class CharT, class Traits>
+    struct streambuf_access : std::basic_streambuf<CharT, Traits>
+    {
+        using std::basic_streambuf<CharT, Traits>::eback;
+        using std::basic_streambuf<CharT, Traits>::gptr;
+        using std::basic_streambuf<CharT, Traits>::egptr;
+        using std::basic_streambuf<CharT, Traits>::setg;
+        using std::basic_streambuf<CharT, Traits>::pbase;
+        using std::basic_streambuf<CharT, Traits>::pptr;
+        using std::basic_streambuf<CharT, Traits>::epptr;
+        using std::basic_streambuf<CharT, Traits>::pbump;
+        using std::basic_streambuf<CharT, Traits>::underflow;
+        using std::basic_streambuf<CharT, Traits>::overflow;
+
+        static streambuf_access* from(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+        {
+            return static_cast<streambuf_access*>(const_cast<std::basic_streambuf<CharT, Traits>*>(buf));
+        }
+    };
+
     template<class CharT, class Traits>
     FILE* filebuf_FILE(const std::basic_filebuf<CharT, Traits>* buf) noexcept
     {
@@ -71,34 +120,160 @@ namespace unsafe
 #endif
     }
 
+    // {buffer, size} of the character buffer of a filebuf. Not supported on MSVC,
+    // where the buffer belongs to the FILE and its size cannot be queried; there and
+    // with other libraries the result is {nullptr, 0}.
     template<class CharT, class Traits>
-    FILE* streambuf_FILE(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+    std::pair<CharT*, std::size_t> filebuf_buffer(const std::basic_filebuf<CharT, Traits>* buf) noexcept
+    {
+#if defined(__GLIBCXX__)
+        struct access : std::basic_filebuf<CharT, Traits> {
+            std::pair<CharT*, std::size_t> get() { return { this->_M_buf, this->_M_buf_size }; }
+        }; return const_cast<access*>(static_cast<const access*>(buf))->get();
+#elif defined(_LIBCPP_VERSION)
+        if (unsafe::get<~5>(*buf))
+            return { reinterpret_cast<CharT*>(unsafe::get<~1>(*buf)), unsafe::get<~2>(*buf) / sizeof(CharT) };
+        return { unsafe::get<~3>(*buf), unsafe::get<~4>(*buf) };
+#else
+        (void)buf;
+        return { nullptr, 0 };
+#endif
+    }
+
+    // Installs the caller-provided buffer [p, p + n), n > 1, into a filebuf, open or not.
+    // Unlike pubsetbuf, any size and alignment (e.g. huge pages) is honored at any time.
+    // Pending output is flushed and unread input is given back by seeking first; returns
+    // false if that fails. The buffer must outlive its use by the filebuf.
+    // Not supported on MSVC, where the buffer is set by setvbuf on the FILE, which is
+    // unspecified after I/O; there it always returns false.
+    template<class CharT, class Traits>
+    bool filebuf_setbuf(std::basic_filebuf<CharT, Traits>* buf, CharT* p, std::size_t n)
     {
-        if (auto f = dynamic_cast<const std::basic_filebuf<CharT, Traits>*>(buf))
-            return filebuf_FILE(f);
+#if defined(_MSVC_STL_UPDATE)
+        (void)buf; (void)p; (void)n;
+        return false;
+#else
+        if (buf->is_open())
+        {
+            if (buf->pubsync() != 0) return false;
+            auto a = streambuf_access<CharT, Traits>::from(buf);
+            const auto pos = buf->pubseekoff(0, std::ios_base::cur);
+            if (pos != decltype(pos)(-1))
+            {
+                if (buf->pubseekpos(pos) == decltype(pos)(-1)) return false;
+            }
+            else if (a->gptr() != a->egptr())
+            {
+                return false;
+            }
+        }
+
 #if defined(__GLIBCXX__)
-        if (auto f = dynamic_cast<__gnu_cxx::stdio_sync_filebuf<CharT, Traits>*>(
-            const_cast<std::basic_streambuf<CharT, Traits>*>(buf)))
-            return f->file();
+        struct access : std::basic_filebuf<CharT, Traits> {
+            void set(CharT* p, std::size_t n) {
+                this->_M_destroy_internal_buffer();
+                this->_M_buf = p;
+                this->_M_buf_size = n;
+                this->_M_reading = false;
+                this->_M_writing = false;
+                this->_M_set_buffer(-1);
+            }
+        }; static_cast<access*>(buf)->set(p, n);
+        return true;
+#else
+        // libc++ honors setbuf on an open filebuf once nothing is buffered.
+        return buf->pubsetbuf(p, static_cast<std::streamsize>(n)) == buf;
+#endif
+#endif
+    }
+
+    enum class streambuf_kind
+    {
+        other,
+        filebuf,    // derived from std::basic_filebuf
+        stdio,      // stdio-synced standard stream buffer over a FILE
+    };
+
+    // Classifies by dynamic type. The result is cached per vtable and type_info, so
+    // repeated lookups for a type cost a few loads and compares instead of RTTI queries.
+    // Both have to match, so that a type from a module loaded where an unloaded one
+    // was does not pick up a stale entry.
+    template<class CharT, class Traits>
+    streambuf_kind classify_streambuf(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+    {
+        // Vtables are pointer aligned, which leaves the low bits for the kind. A slot
+        // gets its vtable once and for all, and its type_info right after.
+        static std::atomic<std::uintptr_t> cache[16];
+        static std::atomic<const std::type_info*> types[16];
+        static_assert(alignof(void*) >= 4);
+
+        const std::uintptr_t vptr = *reinterpret_cast<const std::uintptr_t*>(buf);
+        const std::type_info* type = &typeid(*buf);
+        const std::size_t h = (vptr >> 4) * 0x9E3779B97F4A7C15ull >> 60;
+        for (std::size_t i = 0; i < std::size(cache); ++i)
+        {
+            const std::size_t j = (h + i) % std::size(cache);
+            const std::uintptr_t e = cache[j].load(std::memory_order_relaxed);
+            if (e == 0) break;
+            if ((e & ~std::uintptr_t(3)) == vptr && types[j].load(std::memory_order_relaxed) == type)
+                return static_cast<streambuf_kind>(e & 3);
+        }
+
+        streambuf_kind kind = streambuf_kind::other;
+        if (dynamic_cast<const std::basic_filebuf<CharT, Traits>*>(buf))
+            kind = streambuf_kind::filebuf;
+#if defined(__GLIBCXX__)
+        else if (dynamic_cast<const __gnu_cxx::stdio_sync_filebuf<CharT, Traits>*>(buf))
+            kind = streambuf_kind::stdio;
 #elif defined(_LIBCPP_VERSION)
         // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/src/std_stream.h
-        auto& f = *buf;
-        const char* s = typeid(f).name();
-        if (s && (
+        else if (const char* s = type->name(); s && (
             std::strncmp(s, "NSt3__111__stdoutbuf", 20) == 0 ||
             std::strncmp(s, "NSt3__110__stdinbuf", 19) == 0))
+            kind = streambuf_kind::stdio;
+#endif
+
+        // Racing threads store the same entry; a full cache only costs the slow path.
+        const std::uintptr_t e = vptr | static_cast<std::uintptr_t>(kind);
+        for (std::size_t i = 0; i < std::size(cache); ++i)
         {
-            return *(FILE**)(buf + 1);
+            const std::size_t j = (h + i) % std::size(cache);
+            std::uintptr_t expected = 0;
+            if (cache[j].compare_exchange_strong(expected, e, std::memory_order_relaxed))
+            {
+                types[j].store(type, std::memory_order_relaxed);
+                break;
+            }
+            if (expected == e && types[j].load(std::memory_order_relaxed) == type)
+                break;
         }
+        return kind;
+    }
+
+    template<class CharT, class Traits>
+    FILE* streambuf_FILE(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+    {
+        switch (classify_streambuf(buf))
+        {
+        case streambuf_kind::filebuf:
+            return filebuf_FILE(static_cast<const std::basic_filebuf<CharT, Traits>*>(buf));
+        case streambuf_kind::stdio:
+#if defined(__GLIBCXX__)
+            return static_cast<__gnu_cxx::stdio_sync_filebuf<CharT, Traits>*>(
+                const_cast<std::basic_streambuf<CharT, Traits>*>(buf))->file();
+#elif defined(_LIBCPP_VERSION)
+            return *(FILE**)(buf + 1);
 #endif
-        return nullptr;
+        default:
+            return nullptr;
+        }
     }
 
     template<class CharT, class Traits>
     int streambuf_fileno(const std::basic_streambuf<CharT, Traits>* buf) noexcept
     {
-        if (auto f = dynamic_cast<const std::basic_filebuf<CharT, Traits>*>(buf))
-            return filebuf_fileno(f);
+        if (classify_streambuf(buf) == streambuf_kind::filebuf)
+            return filebuf_fileno(static_cast<const std::basic_filebuf<CharT, Traits>*>(buf));
         if (auto f = streambuf_FILE(buf))
 #if defined(_WIN32)
             return _fileno(f);
@@ -111,8 +286,8 @@ namespace unsafe
     template<class CharT, class Traits>
     auto streambuf_native_handle(const std::basic_streambuf<CharT, Traits>* buf) noexcept
     {
-        if (auto f = dynamic_cast<const std::basic_filebuf<CharT, Traits>*>(buf))
-            return filebuf_native_handle(f);
+        if (classify_streambuf(buf) == streambuf_kind::filebuf)
+            return filebuf_native_handle(static_cast<const std::basic_filebuf<CharT, Traits>*>(buf));
         if (auto f = streambuf_FILE(buf))
 #if defined(_WIN32)
             return (void*)_get_osfhandle(_fileno(f));
@@ -121,6 +296,361 @@ namespace unsafe
 #endif
         return decltype(filebuf_native_handle<CharT, Traits>(nullptr))(-1);
     }
+
+    // The FILE, file descriptor and native handle of a stream, resolved once. Valid
+    // while the streambuf is alive and neither replaced nor reopened.
+    template<class CharT, class Traits = std::char_traits<CharT>>
+    class basic_stream_handle
+    {
+    public:
+        using native_handle_type = decltype(filebuf_native_handle<CharT, Traits>(nullptr));
+
+        explicit basic_stream_handle(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+            : f(buf ? streambuf_FILE(buf) : nullptr),
+              fd(buf ? streambuf_fileno(buf) : -1),
+              h(buf ? streambuf_native_handle(buf) : native_handle_type(-1)) {}
+
+        explicit basic_stream_handle(const std::basic_ios<CharT, Traits>& stream) noexcept
+            : basic_stream_handle(stream.rdbuf()) {}
+
+        FILE* file() const noexcept { return f; }
+        int fileno() const noexcept { return fd; }
+        native_handle_type native_handle() const noexcept { return h; }
+
+    private:
+        FILE* f;
+        int fd;
+        native_handle_type h;
+    };
+
+    using stream_handle = basic_stream_handle<char>;
+    using wstream_handle = basic_stream_handle<wchar_t>;
+
+    // {eback, gptr, egptr}. The characters in [gptr, egptr) are available without copying.
+    template<class CharT, class Traits>
+    std::tuple<CharT*, CharT*, CharT*> get_area(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+    {
+        auto a = streambuf_access<CharT, Traits>::from(buf);
+        return { a->eback(), a->gptr(), a->egptr() };
+    }
+
+    // {pbase, pptr, epptr}. The characters in [pptr, epptr) may be written and then committed.
+    template<class CharT, class Traits>
+    std::tuple<CharT*, CharT*, CharT*> put_area(const std::basic_streambuf<CharT, Traits>* buf) noexcept
+    {
+        auto a = streambuf_access<CharT, Traits>::from(buf);
+        return { a->pbase(), a->pptr(), a->epptr() };
+    }
+
+    // Consumes n <= egptr - gptr characters of the get area.
+    template<class CharT, class Traits>
+    void advance_get(std::basic_streambuf<CharT, Traits>* buf, std::size_t n) noexcept
+    {
+        auto a = streambuf_access<CharT, Traits>::from(buf);
+        a->setg(a->eback(), a->gptr() + n, a->egptr());
+    }
+
+    // Commits n <= epptr - pptr characters written at pptr.
+    template<class CharT, class Traits>
+    void commit_put(std::basic_streambuf<CharT, Traits>* buf, std::size_t n) noexcept
+    {
+        auto a = streambuf_access<CharT, Traits>::from(buf);
+        for (; n > INT_MAX; n -= INT_MAX) a->pbump(INT_MAX);
+        a->pbump(static_cast<int>(n));
+    }
+
+    // Refills the get area once it has been consumed, and returns the number of characters
+    // available at gptr, 0 at end of file. Unlike sgetc, the get area is set up afterwards
+    // for unbuffered streambufs too, so the result may still be 0 for them.
+    template<class CharT, class Traits>
+    std::size_t underflow(std::basic_streambuf<CharT, Traits>* buf)
+    {
+        auto a = streambuf_access<CharT, Traits>::from(buf);
+        if (a->gptr() == a->egptr() && Traits::eq_int_type(a->underflow(), Traits::eof()))
+            return 0;
+        return a->egptr() - a->gptr();
+    }
+
+    // Flushes the put area so that it is available again, and returns its size.
+    template<class CharT, class Traits>
+    std::size_t overflow(std::basic_streambuf<CharT, Traits>* buf)
+    {
+        auto a = streambuf_access<CharT, Traits>::from(buf);
+        if (a->pptr() == a->epptr() && Traits::eq_int_type(a->overflow(Traits::eof()), Traits::eof()))
+            return 0;
+        return a->epptr() - a->pptr();
+    }
+
+#ifndef _WIN32
+    // Moves fd, the file descriptor of buf, to the input position of buf, whose get area
+    // must be drained, and stores the position in pos, or -1 if the file is not seekable.
+    // Returns false if fd cannot be read in place of buf: the FILE under a libc++ filebuf
+    // or a stdio stream reads ahead of the position, and only seeking tells where it is.
+    // After reading n bytes from fd, call buf->pubseekpos(pos + n) unless pos is -1.
+    template<class CharT, class Traits>
+    bool seek_input_fd(std::basic_streambuf<CharT, Traits>* buf, int fd, std::streamoff& pos)
+    {
+        pos = buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        if (pos >= 0) return ::lseek(fd, pos, SEEK_SET) == pos;
+#if defined(__GLIBCXX__)
+        // The libstdc++ filebuf reads fd directly, so fd is where its drained buffer ends.
+        return classify_streambuf(buf) == streambuf_kind::filebuf;
+#else
+        return false;
+#endif
+    }
+#endif
+
+#if defined(__linux__)
+    // Copies up to n bytes from fd in to fd out inside the kernel, trying copy_file_range,
+    // then sendfile, then splice. Returns the number of bytes copied, or -1 with errno set
+    // if no method applies to this pair of files before anything is copied.
+    inline long long fd_copy(int in, int out, long long n) noexcept
+    {
+        long long copied = 0;
+        int method = 0;
+        while (copied < n)
+        {
+            const std::size_t chunk = static_cast<std::size_t>(std::min<long long>(n - copied, 1 << 30));
+            ssize_t r = -1;
+            switch (method)
+            {
+            case 0: r = ::copy_file_range(in, nullptr, out, nullptr, chunk, 0); break;
+            case 1: r = ::sendfile(out, in, nullptr, chunk); break;
+            case 2: r = ::splice(in, nullptr, out, nullptr, chunk, SPLICE_F_MOVE); break;
+            default: return copied ? copied : -1;
+            }
+
+            if (r > 0)
+                copied += r;
+            else if (r == 0)
+                break;
+            else if (errno == EINTR)
+                continue;
+            else if (copied == 0 && (errno == EINVAL || errno == EXDEV || errno == ENOSYS ||
+                                     errno == EBADF || errno == EOPNOTSUPP || errno == ESPIPE))
+                ++method;
+            else
+                return copied ? copied : -1;
+        }
+        return copied;
+    }
+#endif
+
+    // Copies up to n characters from is to os and returns the number copied, like
+    // os << is.rdbuf() but bounded. What is buffered in the streambufs is moved first,
+    // then the bulk is copied inside the kernel with fd_copy when both streams have file
+    // descriptors, after which both streams are repositioned to stay in sync. The rest, or all of it
+    // without descriptors, goes through a buffered loop. Sets eofbit on is if it runs out, badbit on os on errors.
+    inline std::streamsize stream_copy(std::istream& is, std::ostream& os,
+                                       std::streamsize n = std::numeric_limits<std::streamsize>::max())
+    {
+        const std::istream::sentry isentry(is, true);
+        const std::ostream::sentry osentry(os);
+        if (!isentry || !osentry) return 0;
+
+        std::streambuf* ib = is.rdbuf();
+        std::streambuf* ob = os.rdbuf();
+        std::streamsize copied = 0;
+
+        auto [eback, gptr, egptr] = get_area(ib);
+        (void)eback;
+        if (const std::streamsize k = std::min<std::streamsize>(egptr - gptr, n))
+        {
+            const std::streamsize w = ob->sputn(gptr, k);
+            advance_get(ib, static_cast<std::size_t>(w));
+            copied += w;
+            if (w != k)
+            {
+                os.setstate(std::ios_base::badbit);
+                return copied;
+            }
+        }
+
+#if defined(__linux__)
+        const int in = streambuf_fileno(ib);
+        const int out = streambuf_fileno(ob);
+        std::streamoff pos;
+        if (copied < n && in >= 0 && out >= 0 && ob->pubsync() == 0 && seek_input_fd(ib, in, pos))
+        {
+            // Whatever is left after the end of input or an error is handled below.
+            const long long r = fd_copy(in, out, n - copied);
+            if (r > 0) copied += static_cast<std::streamsize>(r);
+            if (pos >= 0) ib->pubseekpos(pos + (r > 0 ? r : 0), std::ios_base::in);
+
+            // The FILE under a libc++ filebuf or a stdio stream caches its offset.
+            if (const off_t end = r > 0 ? ::lseek(out, 0, SEEK_CUR) : -1; end >= 0)
+                ob->pubseekpos(end, std::ios_base::out);
+        }
+#endif
+
+        char buf[65536];
+        while (copied < n)
+        {
+            const std::streamsize k = ib->sgetn(buf, std::min<std::streamsize>(sizeof buf, n - copied));
+            if (k <= 0)
+            {
+                is.setstate(std::ios_base::eofbit);
+                break;
+            }
+
+            const std::streamsize w = ob->sputn(buf, k);
+            copied += w;
+            if (w != k)
+            {
+                os.setstate(std::ios_base::badbit);
+                break;
+            }
+        }
+        return copied;
+    }
+
+    // A streambuf over a FILE locked by the caller, bypassing the per-call locking of stdio.
+    // It buffers at most the one character read ahead by underflow, which is put back
+    // by release(), so the FILE stays usable by printf and friends.
+    class stdio_unlocked_buf : public std::streambuf
+    {
+        FILE* file;
+        char ch = 0;
+
+#if defined(_WIN32)
+        static int put(int c, FILE* f) noexcept { return _fputc_nolock(c, f); }
+        static int get(FILE* f) noexcept { return _fgetc_nolock(f); }
+        static std::size_t write(const char* s, std::size_t n, FILE* f) noexcept { return _fwrite_nolock(s, 1, n, f); }
+        static std::size_t read(char* s, std::size_t n, FILE* f) noexcept { return _fread_nolock(s, 1, n, f); }
+        static int flush(FILE* f) noexcept { return _fflush_nolock(f); }
+#elif defined(__GLIBC__)
+        static int put(int c, FILE* f) noexcept { return putc_unlocked(c, f); }
+        static int get(FILE* f) noexcept { return getc_unlocked(f); }
+        static std::size_t write(const char* s, std::size_t n, FILE* f) noexcept { return fwrite_unlocked(s, 1, n, f); }
+        static std::size_t read(char* s, std::size_t n, FILE* f) noexcept { return fread_unlocked(s, 1, n, f); }
+        static int flush(FILE* f) noexcept { return fflush_unlocked(f); }
+#else
+        static int put(int c, FILE* f) noexcept { return putc_unlocked(c, f); }
+        static int get(FILE* f) noexcept { return getc_unlocked(f); }
+        static std::size_t write(const char* s, std::size_t n, FILE* f) noexcept
+        {
+            std::size_t i = 0;
+            while (i < n && putc_unlocked(static_cast<unsigned char>(s[i]), f) != EOF) ++i;
+            return i;
+        }
+        static std::size_t read(char* s, std::size_t n, FILE* f) noexcept
+        {
+            std::size_t i = 0;
+            for (int c; i < n && (c = getc_unlocked(f)) != EOF; ++i) s[i] = static_cast<char>(c);
+            return i;
+        }
+        static int flush(FILE* f) noexcept { return std::fflush(f); }
+#endif
+
+    public:
+        explicit stdio_unlocked_buf(FILE* file) noexcept : file(file) {}
+
+        // Puts back the character read ahead, if any.
+        void release() noexcept
+        {
+            if (gptr() < egptr()) std::ungetc(static_cast<unsigned char>(*gptr()), file);
+            setg(nullptr, nullptr, nullptr);
+        }
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+            return put(static_cast<unsigned char>(traits_type::to_char_type(c)), file) == EOF ? traits_type::eof() : c;
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            return static_cast<std::streamsize>(write(s, static_cast<std::size_t>(n), file));
+        }
+
+        int_type underflow() override
+        {
+            const int c = get(file);
+            if (c == EOF) return traits_type::eof();
+            ch = static_cast<char>(c);
+            setg(&ch, &ch, &ch + 1);
+            return traits_type::to_int_type(ch);
+        }
+
+        std::streamsize xsgetn(char* s, std::streamsize n) override
+        {
+            std::streamsize k = 0;
+            if (n > 0 && gptr() < egptr())
+            {
+                *s = *gptr();
+                setg(nullptr, nullptr, nullptr);
+                k = 1;
+            }
+            return k + static_cast<std::streamsize>(read(s + k, static_cast<std::size_t>(n - k), file));
+        }
+
+        int_type pbackfail(int_type c) override
+        {
+            release();
+            const int r = traits_type::eq_int_type(c, traits_type::eof()) ? EOF : std::ungetc(c, file);
+            return r == EOF ? traits_type::eof() : traits_type::to_int_type(static_cast<char>(r));
+        }
+
+        int sync() override
+        {
+            return flush(file) == 0 ? 0 : -1;
+        }
+    };
+
+    // Locks the FILE behind a stdio-synced stream such as std::cout once for the scope,
+    // and meanwhile routes the stream through a stdio_unlocked_buf. Streams not backed by
+    // a stdio FILE, e.g. std::ofstream or std::cout after sync_with_stdio(false), are
+    // left alone. Other threads using the FILE block until the scope ends.
+    class stdio_lock
+    {
+        struct access : std::ios {
+            using std::ios::set_rdbuf;
+        };
+
+        std::ios& stream;
+        FILE* file;
+        std::streambuf* saved = nullptr;
+        stdio_unlocked_buf buf;
+
+        static FILE* stdio_file(const std::streambuf* sb) noexcept
+        {
+            if (sb == nullptr || classify_streambuf(sb) != streambuf_kind::stdio) return nullptr;
+            return streambuf_FILE(sb);
+        }
+
+    public:
+        explicit stdio_lock(std::ios& stream) noexcept
+            : stream(stream), file(stdio_file(stream.rdbuf())), buf(file)
+        {
+            if (file == nullptr) return;
+#if defined(_WIN32)
+            _lock_file(file);
+#else
+            flockfile(file);
+#endif
+            saved = stream.rdbuf();
+            static_cast<access&>(stream).set_rdbuf(&buf);
+        }
+
+        stdio_lock(const stdio_lock&) = delete;
+        stdio_lock& operator=(const stdio_lock&) = delete;
+
+        ~stdio_lock()
+        {
+            if (file == nullptr) return;
+            buf.release();
+            static_cast<access&>(stream).set_rdbuf(saved);
+#if defined(_WIN32)
+            _unlock_file(file);
+#else
+            funlockfile(file);
+#endif
+        }
+
+        bool locked() const noexcept { return file != nullptr; }
+    };
 }
 
 #endif
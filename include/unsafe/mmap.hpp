@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_MMAP_HPP
+#define UNSAFE_MMAP_HPP
+
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close, sysconf
+
+#include "vector.hpp"
+#include "string.hpp"
+
+namespace unsafe
+{
+    enum class map_mode
+    {
+        read_only,      // PROT_READ, MAP_SHARED
+        copy_on_write,  // PROT_READ | PROT_WRITE, MAP_PRIVATE
+    };
+
+    enum class map_advice
+    {
+        normal = MADV_NORMAL,
+        sequential = MADV_SEQUENTIAL,
+        random = MADV_RANDOM,
+        willneed = MADV_WILLNEED,
+        dontneed = MADV_DONTNEED,
+    };
+
+    // Owning mapping of a whole file. At least pad zero bytes follow the file contents,
+    // which gives strings their terminator even if the file size is a multiple of the
+    // page size: an anonymous region is reserved first and the file is mapped over it.
+    class mapped_file
+    {
+        void* addr = nullptr;
+        std::size_t length = 0;
+        std::size_t bytes = 0;
+
+    public:
+        explicit mapped_file(const char* path, map_mode mode = map_mode::read_only, std::size_t pad = 0)
+        {
+            const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                const int e = errno;
+                ::close(fd);
+                throw std::system_error(e, std::generic_category(), "fstat");
+            }
+
+            const bool cow = mode == map_mode::copy_on_write;
+            const int prot = cow ? PROT_READ | PROT_WRITE : PROT_READ;
+            const std::size_t page = ::sysconf(_SC_PAGESIZE);
+            bytes = static_cast<std::size_t>(st.st_size);
+            length = (bytes + pad + page - 1) / page * page;
+
+            if (length != 0)
+            {
+                addr = ::mmap(nullptr, length, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (addr != MAP_FAILED && bytes != 0 && ::mmap(addr, bytes, prot,
+                    (cow ? MAP_PRIVATE : MAP_SHARED) | MAP_FIXED, fd, 0) == MAP_FAILED)
+                {
+                    const int e = errno;
+                    ::munmap(addr, length);
+                    errno = e;
+                    addr = MAP_FAILED;
+                }
+            }
+
+            const int e = errno;
+            ::close(fd);
+            if (addr == MAP_FAILED) throw std::system_error(e, std::generic_category(), "mmap");
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        ~mapped_file()
+        {
+            if (length != 0) ::munmap(addr, length);
+        }
+
+        void* data() const noexcept { return addr; }
+        std::size_t size() const noexcept { return bytes; }
+
+        int advise(map_advice advice) noexcept
+        {
+            return length == 0 || ::madvise(addr, length, static_cast<int>(advice)) == 0 ? 0 : errno;
+        }
+    };
+
+    // A file mapped as a std::vector<T>, which must not change size or capacity.
+    // A read_only mapping is only presented as a const std::vector, copy_on_write
+    // ones may have their elements written.
+    template<typename T, map_mode M = map_mode::read_only, class A = std::allocator<T>>
+    class mapped_vector
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+        using element_type = std::conditional_t<M == map_mode::read_only, const T, T>;
+        using vector_type = std::conditional_t<M == map_mode::read_only, const std::vector<T, A>, std::vector<T, A>>;
+
+        mapped_file file;
+        borrowed_vector<element_type, A> bv;
+
+    public:
+        explicit mapped_vector(const char* path)
+            : file(path, M), bv(static_cast<element_type*>(file.data()), file.size() / sizeof(T)) {}
+
+        int advise(map_advice advice) noexcept { return file.advise(advice); }
+
+        vector_type& get() noexcept { return bv; }
+        const std::vector<T, A>& get() const noexcept { return bv; }
+        operator vector_type&() noexcept { return bv; }
+        operator const std::vector<T, A>&() const noexcept { return bv; }
+    };
+
+    // A file mapped as a null-terminated std::basic_string, which must not change size
+    // or capacity. A read_only mapping is only presented as a const std::basic_string,
+    // copy_on_write ones may have their characters written.
+    template<typename C, map_mode M = map_mode::read_only, class T = std::char_traits<C>, class A = std::allocator<C>>
+    class mapped_string
+    {
+        using char_type = std::conditional_t<M == map_mode::read_only, const C, C>;
+        using string_type = std::conditional_t<M == map_mode::read_only, const std::basic_string<C, T, A>, std::basic_string<C, T, A>>;
+
+        mapped_file file;
+        borrowed_string<char_type, T, A> bs;
+
+    public:
+        explicit mapped_string(const char* path)
+            : file(path, M, sizeof(C)), bs(static_cast<char_type*>(file.data()), file.size() / sizeof(C)) {}
+
+        int advise(map_advice advice) noexcept { return file.advise(advice); }
+
+        string_type& get() noexcept { return bs; }
+        const std::basic_string<C, T, A>& get() const noexcept { return bs; }
+        operator string_type&() noexcept { return bs; }
+        operator const std::basic_string<C, T, A>&() const noexcept { return bs; }
+    };
+}
+
+#endif
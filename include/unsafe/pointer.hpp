@@ -10,6 +10,10 @@
 
 #include <type_traits>
 #include <memory>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <thread> // yield
 
 namespace unsafe
 {
@@ -21,6 +25,14 @@ namespace unsafe
         return { reinterpret_cast<T*&>(ps[p]), ps[1 - p] };
     }
 
+    template<typename T>
+    std::pair<T*&, void*&> unpack_ptr(std::weak_ptr<T> const& wp) noexcept
+    {
+        void*(&ps)[2] = reinterpret_cast<void*(&)[2]>(const_cast<std::weak_ptr<T>&>(wp));
+        const int p = 0;
+        return { reinterpret_cast<T*&>(ps[p]), ps[1 - p] };
+    }
+
     template<class T>
     struct enable_shared_from_this
     {
@@ -30,6 +42,68 @@ namespace unsafe
         static const bool value = std::is_void_v<decltype(test(static_cast<std::remove_const_t<T>*>(nullptr)))>;
     };
 
+    // The reference counts at the beginning of every shared_ptr control block, after
+    // its vtable pointer. use_count() and weak_count() are what shared_ptr::use_count()
+    // and weak_ptr::use_count() would report; the stored values are biased differently.
+    struct control_block
+    {
+#if defined(_MSVC_STL_UPDATE)
+        // https://github.com/microsoft/STL/blob/vs-2022-17.9/stl/inc/memory
+        using count_type = unsigned long; // #shared, #weak + (#shared != 0)
+        static constexpr long bias = 0;
+#elif defined(__GLIBCXX__)
+        // https://github.com/gcc-mirror/gcc/blob/releases/gcc-13.2.0/libstdc++-v3/include/bits/shared_ptr_base.h#L237-L238
+        using count_type = _Atomic_word; // #shared, #weak + (#shared != 0)
+        static constexpr long bias = 0;
+#elif defined(_LIBCPP_VERSION)
+        // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/include/__memory/shared_ptr.h
+        using count_type = long; // #shared - 1, #weak + (#shared != 0) - 1
+        static constexpr long bias = 1;
+#endif
+
+        void* vtbl;
+        count_type uses;
+        count_type weaks;
+
+        long use_count() const noexcept { return static_cast<long>(count(uses).load(std::memory_order_relaxed)) + bias; }
+        long weak_count() const noexcept { return static_cast<long>(count(weaks).load(std::memory_order_relaxed)) + bias - (use_count() != 0); }
+
+        // Adds n owners with a single atomic instruction; each must later be dropped
+        // by a shared_ptr built on this block or by release(n).
+        void retain(long n = 1) noexcept { count(uses).fetch_add(static_cast<count_type>(n), std::memory_order_relaxed); }
+
+        // Drops n owners with a single atomic instruction. At least one must remain,
+        // the last owner has to go through shared_ptr to destroy the object.
+        void release(long n = 1) noexcept { count(uses).fetch_sub(static_cast<count_type>(n), std::memory_order_release); }
+
+    private:
+        // The library updates the counts atomically while other threads may hold owners,
+        // so they are never touched as plain integers.
+        static std::atomic<count_type>& count(const count_type& c) noexcept
+        {
+            static_assert(sizeof(std::atomic<count_type>) == sizeof(count_type));
+            return reinterpret_cast<std::atomic<count_type>&>(const_cast<count_type&>(c));
+        }
+    };
+
+    template<typename T>
+    control_block* get_control_block(std::shared_ptr<T> const& sp) noexcept
+    {
+        return static_cast<control_block*>(unpack_ptr(sp).second);
+    }
+
+    // The weak_ptr that std::enable_shared_from_this holds as its only member.
+    template<typename U>
+    std::weak_ptr<U> const& weak_from_this(std::enable_shared_from_this<U> const& base) noexcept
+    {
+        static_assert(sizeof(std::enable_shared_from_this<U>) == sizeof(std::weak_ptr<U>));
+        return reinterpret_cast<std::weak_ptr<U> const&>(base);
+    }
+
+    // The two functions below read the control block out of the weak_ptr in the
+    // object instead of calling shared_from_this(), so a round trip through a raw
+    // pointer touches no reference count at all.
+
     template<class T>
     T* release_from_this(std::shared_ptr<T> sp)
     {
@@ -37,7 +111,7 @@ namespace unsafe
         if (!sp) return nullptr;
 
         auto ps = unpack_ptr(sp);
-        if (ps.second != unpack_ptr(sp->shared_from_this()).second)
+        if (ps.second != unpack_ptr(weak_from_this(*sp)).second)
             throw std::bad_weak_ptr();
 
         ps.second = nullptr;
@@ -50,10 +124,220 @@ namespace unsafe
         static_assert(enable_shared_from_this<T>::value, "T must derive from std::enable_shared_from_this");
         if (p == nullptr) return {};
 
-        auto sp = p->shared_from_this();
-        unpack_ptr(std::shared_ptr<void>{}).second = unpack_ptr(sp).second;
-        return { std::move(sp), p };
+        void* cb = unpack_ptr(weak_from_this(*p)).second;
+        if (cb == nullptr || static_cast<control_block*>(cb)->use_count() == 0)
+            throw std::bad_weak_ptr();
+
+        std::shared_ptr<T> sp;
+        unpack_ptr(sp).first = p;
+        unpack_ptr(sp).second = cb;
+        return sp;
     }
+
+    // A shared_ptr whose owners all stay on one thread, e.g. inside an event loop.
+    // Like boost::local_shared_ptr, the local owners hold one std::shared_ptr between
+    // them through a block counting them with plain arithmetic, so copying and destroying
+    // skip atomic instructions, while the shared_ptr itself is counted by the library as
+    // usual. Owners on other threads are to be made by copying shared().
+    template<typename T>
+    class local_shared_ptr
+    {
+        struct block
+        {
+            std::shared_ptr<T> sp;
+            long count;
+        };
+
+        block* pb = nullptr;
+
+    public:
+        using element_type = typename std::shared_ptr<T>::element_type;
+
+        local_shared_ptr() noexcept = default;
+        local_shared_ptr(std::nullptr_t) noexcept {}
+        local_shared_ptr(std::shared_ptr<T> p) : pb(p ? new block{std::move(p), 1} : nullptr) {}
+        local_shared_ptr(const local_shared_ptr& other) noexcept : pb(other.pb) { if (pb) ++pb->count; }
+        local_shared_ptr(local_shared_ptr&& other) noexcept : pb(other.pb) { other.pb = nullptr; }
+        ~local_shared_ptr() { if (pb && --pb->count == 0) delete pb; }
+
+        local_shared_ptr& operator=(local_shared_ptr other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        void reset() noexcept { local_shared_ptr().swap(*this); }
+        void swap(local_shared_ptr& other) noexcept { std::swap(pb, other.pb); }
+
+        element_type* get() const noexcept { return pb ? pb->sp.get() : nullptr; }
+        T& operator*() const noexcept { return *get(); }
+        T* operator->() const noexcept { return get(); }
+        explicit operator bool() const noexcept { return pb != nullptr; }
+
+        // The local owners plus the shared_ptr copies made from shared().
+        long use_count() const noexcept { return pb ? pb->count + pb->sp.use_count() - 1 : 0; }
+        long local_use_count() const noexcept { return pb ? pb->count : 0; }
+
+        std::shared_ptr<T> shared() const noexcept { return pb ? pb->sp : nullptr; }
+    };
+
+    // Whether a and b store the same pointer and share ownership, as atomic<shared_ptr> compares.
+    template<typename T>
+    bool equivalent(std::shared_ptr<T> const& a, std::shared_ptr<T> const& b) noexcept
+    {
+        return unpack_ptr(a).first == unpack_ptr(b).first && unpack_ptr(a).second == unpack_ptr(b).second;
+    }
+
+    // Lock-free replacement of the std::atomic_load/std::atomic_store overloads for
+    // std::shared_ptr, which lock a global mutex pool in libstdc++ and libc++.
+    // The value is kept in a node, whose address shares one word with a count of the
+    // readers currently copying out of it (split reference counting). A reader bumps
+    // the count, copies the shared_ptr and gives its count back, to the word if the
+    // node is still installed and otherwise to the node, which is freed by whoever
+    // drops the last count. Needs 64-bit pointers with the top 16 bits unused, and
+    // admits 32767 readers at once; more back off until one is done, which leaves
+    // room for the count to take up to 32768 more threads backing off at the same time.
+    template<typename T>
+    class atomic_shared_ptr
+    {
+        static_assert(sizeof(void*) == 8, "atomic_shared_ptr needs 64-bit pointers");
+
+        struct node
+        {
+            std::shared_ptr<T> sp;
+            std::atomic<long> inner{0};
+        };
+
+        static constexpr int shift = 48;
+        static constexpr std::uint64_t one = std::uint64_t(1) << shift;
+        static constexpr std::uint64_t mask = one - 1;
+        static constexpr std::uint64_t max_readers = (std::uint64_t(1) << (63 - shift)) - 1;
+
+        mutable std::atomic<std::uint64_t> word;
+
+        static node* get(std::uint64_t w) noexcept
+        {
+            return reinterpret_cast<node*>(static_cast<std::uintptr_t>(w & mask));
+        }
+
+        static std::uint64_t make(std::shared_ptr<T> sp)
+        {
+            if (!sp && !unpack_ptr(sp).second) return 0;
+            const std::uint64_t w = reinterpret_cast<std::uintptr_t>(new node{std::move(sp)});
+            assert((w & ~mask) == 0 && "the top 16 bits of pointers are used");
+            return w;
+        }
+
+        // Transfers the outstanding readers of a swapped out word to its node.
+        static void retire(std::uint64_t w, long self = 0) noexcept
+        {
+            const long n = static_cast<long>(w >> shift) - self;
+            if (node* p = get(w); p && p->inner.fetch_add(n, std::memory_order_acq_rel) + n == 0)
+                delete p;
+        }
+
+        std::uint64_t acquire() const noexcept
+        {
+            for (;;)
+            {
+                const std::uint64_t w = word.fetch_add(one, std::memory_order_acquire) + one;
+                if ((w >> shift) <= max_readers || !get(w)) return w;
+                release(w);
+                std::this_thread::yield();
+            }
+        }
+
+        // Counts left in a word holding no node are never given back, they wrap harmlessly.
+        void release(std::uint64_t w) const noexcept
+        {
+            node* p = get(w);
+            if (!p) return;
+            while (get(w) == p)
+                if (word.compare_exchange_weak(w, w - one, std::memory_order_release, std::memory_order_relaxed))
+                    return;
+            if (p->inner.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete p;
+        }
+
+    public:
+        atomic_shared_ptr() noexcept : word(0) {}
+        atomic_shared_ptr(std::shared_ptr<T> sp) : word(make(std::move(sp))) {}
+        atomic_shared_ptr(const atomic_shared_ptr&) = delete;
+        atomic_shared_ptr& operator=(const atomic_shared_ptr&) = delete;
+        ~atomic_shared_ptr() { retire(word.load(std::memory_order_acquire)); }
+
+        bool is_lock_free() const noexcept { return word.is_lock_free(); }
+
+        std::shared_ptr<T> load() const
+        {
+            const std::uint64_t w = acquire();
+            std::shared_ptr<T> r;
+            if (node* p = get(w)) r = p->sp;
+            release(w);
+            return r;
+        }
+
+        operator std::shared_ptr<T>() const { return load(); }
+
+        void store(std::shared_ptr<T> sp)
+        {
+            retire(word.exchange(make(std::move(sp)), std::memory_order_acq_rel));
+        }
+
+        std::shared_ptr<T> exchange(std::shared_ptr<T> sp)
+        {
+            const std::uint64_t w = word.exchange(make(std::move(sp)), std::memory_order_acq_rel);
+            node* p = get(w);
+            if (!p) return nullptr;
+
+            // Without readers in flight the node is ours alone.
+            if ((w >> shift) == 0 && p->inner.load(std::memory_order_acquire) == 0)
+            {
+                std::shared_ptr<T> r = std::move(p->sp);
+                delete p;
+                return r;
+            }
+
+            std::shared_ptr<T> r = p->sp;
+            retire(w);
+            return r;
+        }
+
+        // Never fails spuriously. On failure expected is set to the current value.
+        bool compare_exchange_strong(std::shared_ptr<T>& expected, std::shared_ptr<T> desired)
+        {
+            std::uint64_t d = ~std::uint64_t(0);
+            for (;;)
+            {
+                const std::uint64_t w = acquire();
+                node* p = get(w);
+                if (p ? !equivalent(p->sp, expected) : expected || unpack_ptr(expected).second)
+                {
+                    expected = p ? p->sp : nullptr;
+                    release(w);
+                    if (d != ~std::uint64_t(0)) retire(d);
+                    return false;
+                }
+
+                if (d == ~std::uint64_t(0)) d = make(std::move(desired));
+                std::uint64_t cur = w;
+                while (get(cur) == p)
+                {
+                    if (word.compare_exchange_weak(cur, d, std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        retire(cur, 1);
+                        return true;
+                    }
+                }
+                release(w);
+            }
+        }
+
+        bool compare_exchange_weak(std::shared_ptr<T>& expected, std::shared_ptr<T> desired)
+        {
+            return compare_exchange_strong(expected, std::move(desired));
+        }
+    };
 }
 
 #endif
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_POOL_HPP
+#define UNSAFE_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace unsafe
+{
+    // Per-thread pool of fixed-size blocks, carved out of chunks aligned to their size
+    // so that a block finds the chunk header, and thereby its pool, by masking its
+    // address. Blocks freed by the owning thread go to a plain free list, blocks freed
+    // by other threads to a lock-free stack the owner takes over when it runs dry.
+    // A pool outliving its thread with blocks still out is freed by the last of them.
+    template<std::size_t Size, std::size_t Align>
+    class slab
+    {
+    public:
+        static constexpr std::size_t chunk_size = 64 * 1024;
+        static constexpr std::size_t align = Align < alignof(void*) ? alignof(void*) : Align;
+        static constexpr std::size_t block_size = ((Size < sizeof(void*) ? sizeof(void*) : Size) + align - 1) / align * align;
+        static constexpr bool pooled = block_size <= chunk_size / 16 && align <= chunk_size / 16;
+
+        static void* allocate()
+        {
+            if constexpr (!pooled) return ::operator new(Size, std::align_val_t(align));
+            else return local().pop();
+        }
+
+        static void deallocate(void* p) noexcept
+        {
+            if constexpr (!pooled) ::operator delete(p, std::align_val_t(align));
+            else
+            {
+                slab* owner = reinterpret_cast<header*>(reinterpret_cast<std::uintptr_t>(p) & ~(chunk_size - 1))->owner;
+                if (owner == current) owner->push(p);
+                else owner->push_remote(p);
+            }
+        }
+
+    private:
+        struct header { slab* owner; };
+        struct node { node* next; };
+        static constexpr std::size_t first = (sizeof(header) + align - 1) / align * align;
+
+        node* free_list = nullptr;
+        std::size_t free_count = 0;
+        std::atomic<node*> remote{nullptr};
+        std::atomic<long> orphans{0};
+        char* bump = nullptr;
+        char* end = nullptr;
+        std::size_t carved = 0;
+        std::vector<void*> chunks;
+
+        static inline thread_local slab* current = nullptr;
+
+        struct holder
+        {
+            slab* p = new slab;
+            holder() { current = p; }
+            ~holder()
+            {
+                current = nullptr;
+                p->orphan();
+            }
+        };
+
+        static slab& local()
+        {
+            static thread_local holder h;
+            return *h.p;
+        }
+
+        ~slab()
+        {
+            for (void* c : chunks) ::operator delete(c, std::align_val_t(chunk_size));
+        }
+
+        static node* orphaned() noexcept { return reinterpret_cast<node*>(alignof(node)); }
+
+        // On thread exit, the blocks still out count down to freeing the pool.
+        void orphan() noexcept
+        {
+            long n = static_cast<long>(carved - free_count);
+            for (node* r = remote.exchange(orphaned(), std::memory_order_acq_rel); r; r = r->next) --n;
+            if (orphans.fetch_add(n, std::memory_order_acq_rel) + n == 0) delete this;
+        }
+
+        void* pop()
+        {
+            if (!free_list)
+            {
+                free_list = remote.exchange(nullptr, std::memory_order_acquire);
+                for (node* r = free_list; r; r = r->next) ++free_count;
+            }
+            if (node* n = free_list)
+            {
+                free_list = n->next;
+                --free_count;
+                return n;
+            }
+
+            if (bump + block_size > end)
+            {
+                chunks.reserve(chunks.size() + 1);
+                char* c = static_cast<char*>(::operator new(chunk_size, std::align_val_t(chunk_size)));
+                chunks.push_back(c);
+                reinterpret_cast<header*>(c)->owner = this;
+                bump = c + first;
+                end = c + chunk_size;
+            }
+            void* p = bump;
+            bump += block_size;
+            ++carved;
+            return p;
+        }
+
+        void push(void* p) noexcept
+        {
+            node* n = static_cast<node*>(p);
+            n->next = free_list;
+            free_list = n;
+            ++free_count;
+        }
+
+        void push_remote(void* p) noexcept
+        {
+            node* n = static_cast<node*>(p);
+            n->next = remote.load(std::memory_order_relaxed);
+            do
+            {
+                if (n->next == orphaned())
+                {
+                    if (orphans.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+                    return;
+                }
+            } while (!remote.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed));
+        }
+    };
+
+    // Stateless allocator drawing single objects from the slab of the calling thread.
+    // Being empty, it adds nothing to the control blocks of allocate_shared.
+    template<typename T>
+    struct slab_allocator
+    {
+        using value_type = T;
+
+        slab_allocator() noexcept = default;
+        template<typename U>
+        slab_allocator(const slab_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n)
+        {
+            if (n != 1) return std::allocator<T>().allocate(n);
+            return static_cast<T*>(slab<sizeof(T), alignof(T)>::allocate());
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept
+        {
+            if (n != 1) return std::allocator<T>().deallocate(p, n);
+            slab<sizeof(T), alignof(T)>::deallocate(p);
+        }
+
+        template<typename U>
+        bool operator==(const slab_allocator<U>&) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const slab_allocator<U>&) const noexcept { return false; }
+    };
+
+    // Like std::make_shared, with the object and its control block in one slab block.
+    // The shared_ptr may be copied to and released on any thread.
+    template<typename T, typename... Args>
+    std::shared_ptr<T> make_pooled(Args&&... args)
+    {
+        return std::allocate_shared<T>(slab_allocator<T>(), std::forward<Args>(args)...);
+    }
+}
+
+#endif
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_READ_HPP
+#define UNSAFE_READ_HPP
+
+#include <cerrno>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/stat.h> // fstat
+#include <unistd.h> // read
+#endif
+
+#include "iostream.hpp"
+#include "vector.hpp"
+#include "string.hpp"
+
+namespace unsafe
+{
+    // Resizes c to n characters, leaving the new ones uninitialized, and returns data().
+    template<typename C, class A>
+    C* resize_for_overwrite(std::vector<C, A>& c, std::size_t n)
+    {
+        return resize_uninitialized(c, n);
+    }
+
+    template<typename C, class T, class A>
+    C* resize_for_overwrite(std::basic_string<C, T, A>& c, std::size_t n)
+    {
+        if (n > c.capacity()) c.reserve(n < 2 * c.size() ? 2 * c.size() : n);
+#if defined(_LIBCPP_VERSION) && !defined(__cpp_lib_string_resize_and_overwrite)
+        // unsafe::basic_string has no libc++ layout, but libc++ has its own hook.
+        // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/include/string
+        c.__resize_default_init(n);
+#else
+        resize_and_overwrite(c, n, [](C*, std::size_t n) { return n; });
+#endif
+        return c.data();
+    }
+
+    // Appends up to n characters of is to c and returns the number appended. What the
+    // streambuf has buffered is taken first. The rest is read from the file descriptor
+    // straight into the uninitialized tail of c, which is sized once from fstat for
+    // regular files, or through sgetn for streams without a descriptor that can be read
+    // in their place (see seek_input_fd). Sets eofbit if is runs out.
+    template<class Container>
+    std::size_t read_n_some(std::istream& is, Container& c, std::size_t n)
+    {
+        static_assert(sizeof(typename Container::value_type) == 1, "Container must hold bytes");
+
+        const std::istream::sentry sentry(is, true);
+        if (!sentry) return 0;
+
+        std::streambuf* buf = is.rdbuf();
+        const std::size_t size = c.size();
+        std::size_t got = 0;
+
+        auto [eback, gptr, egptr] = get_area(buf);
+        (void)eback;
+        if (const std::size_t k = std::min<std::size_t>(egptr - gptr, n))
+        {
+            std::memcpy(resize_for_overwrite(c, size + k) + size, gptr, k);
+            advance_get(buf, k);
+            got = k;
+        }
+
+        std::size_t chunk = 65536;
+        bool eof = false;
+
+#ifndef _WIN32
+        const int fd = streambuf_fileno(buf);
+        std::streamoff pos;
+        if (got < n && fd >= 0 && seek_input_fd(buf, fd, pos))
+        {
+            const std::size_t start = got;
+            // What fstat reports to be left of a regular file, if sized.
+            std::size_t remaining = 0;
+            bool sized = false;
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && pos >= 0)
+            {
+                remaining = st.st_size > pos ? static_cast<std::size_t>(st.st_size - pos) : 0;
+                sized = true;
+            }
+
+            while (got < n)
+            {
+                ssize_t r;
+                if (sized && remaining == 0)
+                {
+                    // Read as far as fstat reported; look for the end without growing c.
+                    char probe[4096];
+                    do r = ::read(fd, probe, std::min(sizeof probe, n - got));
+                    while (r < 0 && errno == EINTR);
+                    if (r > 0)
+                    {
+                        std::memcpy(resize_for_overwrite(c, size + got + r) + size + got, probe, r);
+                        got += static_cast<std::size_t>(r);
+                    }
+                    sized = false;
+                }
+                else
+                {
+                    const std::size_t want = std::min(sized ? remaining : chunk, n - got);
+                    char* p = reinterpret_cast<char*>(resize_for_overwrite(c, size + got + want)) + size + got;
+                    do r = ::read(fd, p, want);
+                    while (r < 0 && errno == EINTR);
+                    if (r > 0)
+                    {
+                        got += static_cast<std::size_t>(r);
+                        if (sized)
+                            remaining -= static_cast<std::size_t>(r);
+                        else if (static_cast<std::size_t>(r) == want && chunk < (std::size_t(1) << 30))
+                            chunk *= 2;
+                    }
+                }
+
+                if (r <= 0)
+                {
+                    eof = r == 0;
+                    if (r < 0) is.setstate(std::ios_base::badbit);
+                    break;
+                }
+            }
+            resize_for_overwrite(c, size + got);
+            if (pos >= 0) buf->pubseekpos(pos + static_cast<std::streamoff>(got - start), std::ios_base::in);
+            if (eof) is.setstate(std::ios_base::eofbit);
+            return got;
+        }
+#endif
+
+        while (got < n)
+        {
+            const std::size_t want = std::min(chunk, n - got);
+            char* p = reinterpret_cast<char*>(resize_for_overwrite(c, size + got + want)) + size + got;
+            const std::streamsize r = buf->sgetn(p, static_cast<std::streamsize>(want));
+            got += r > 0 ? static_cast<std::size_t>(r) : 0;
+            if (static_cast<std::size_t>(r) != want)
+            {
+                eof = true;
+                break;
+            }
+            if (chunk < (std::size_t(1) << 30)) chunk *= 2;
+        }
+        resize_for_overwrite(c, size + got);
+        if (eof) is.setstate(std::ios_base::eofbit);
+        return got;
+    }
+
+    // Appends the rest of is to c, like c.append(std::istreambuf_iterator<char>(is), {}).
+    template<class Container>
+    std::size_t read_all(std::istream& is, Container& c)
+    {
+        return read_n_some(is, c, std::numeric_limits<std::size_t>::max());
+    }
+
+    // Appends n characters of is to c, like is.read, setting failbit if fewer are available.
+    template<class Container>
+    std::size_t read_n(std::istream& is, Container& c, std::size_t n)
+    {
+        const std::size_t got = read_n_some(is, c, n);
+        if (got < n) is.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+        return got;
+    }
+}
+
+#endif
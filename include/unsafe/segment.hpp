@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_SEGMENT_HPP
+#define UNSAFE_SEGMENT_HPP
+
+#include <cstdint>
+#include <cstring> // memcpy
+#include <new> // bad_alloc
+#include <type_traits>
+
+#include "vector.hpp"
+#include "string.hpp"
+
+namespace unsafe
+{
+    // Position independent headers of containers stored in a memory segment, e.g.
+    // shared memory or a file. The offsets are relative to the segment base, so the
+    // headers stay valid wherever each process maps the segment.
+    template<typename T>
+    struct segment_vector
+    {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    // The characters are followed by a terminator in the segment.
+    template<typename C>
+    struct segment_string
+    {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    // Bump allocator that lays out headers and container contents in a segment.
+    class segment_writer
+    {
+        unsigned char* base;
+        std::size_t capacity;
+        std::size_t used = 0;
+
+    public:
+        segment_writer(void* base, std::size_t capacity) noexcept
+            : base(static_cast<unsigned char*>(base)), capacity(capacity) {}
+
+        void* data() const noexcept { return base; }
+        std::size_t size() const noexcept { return used; }
+
+        // Returns the offset of n bytes aligned to align, or throws std::bad_alloc.
+        std::size_t allocate(std::size_t n, std::size_t align)
+        {
+            const std::size_t offset = (used + align - 1) / align * align;
+            if (offset > capacity || n > capacity - offset) throw std::bad_alloc();
+            used = offset + n;
+            return offset;
+        }
+
+        // Value-initializes a T, typically the root header, and returns a pointer to it.
+        template<typename T>
+        T* construct()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+            return new (base + allocate(sizeof(T), alignof(T))) T();
+        }
+
+        template<typename T>
+        segment_vector<T> store(const T* data, std::size_t size)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+            const std::size_t offset = allocate(sizeof(T) * size, alignof(T));
+            if (size) std::memcpy(base + offset, data, sizeof(T) * size);
+            return { offset, size };
+        }
+
+        template<typename T, class A>
+        segment_vector<T> store(const std::vector<T, A>& v)
+        {
+            return store(v.data(), v.size());
+        }
+
+        template<typename C, class T, class A>
+        segment_string<C> store(const std::basic_string<C, T, A>& s)
+        {
+            const std::size_t offset = allocate(sizeof(C) * (s.size() + 1), alignof(C));
+            std::memcpy(base + offset, s.c_str(), sizeof(C) * (s.size() + 1));
+            return { offset, s.size() };
+        }
+    };
+
+    template<typename T>
+    const T* segment_at(const void* base, std::uint64_t offset) noexcept
+    {
+        return reinterpret_cast<const T*>(static_cast<const unsigned char*>(base) + offset);
+    }
+
+    template<typename T>
+    T* segment_at(void* base, std::uint64_t offset) noexcept
+    {
+        return reinterpret_cast<T*>(static_cast<unsigned char*>(base) + offset);
+    }
+
+    // Presents a stored vector as a std::vector of the calling process without copying.
+    // The segment must stay mapped at base while the result is alive. A const base,
+    // e.g. a read-only mapping, is only presented as a const std::vector.
+    template<typename T, class A = std::allocator<T>>
+    borrowed_vector<const T, A> rehydrate(const void* base, const segment_vector<T>& h) noexcept
+    {
+        return { segment_at<T>(base, h.offset), static_cast<std::size_t>(h.size) };
+    }
+
+    template<typename T, class A = std::allocator<T>>
+    borrowed_vector<T, A> rehydrate(void* base, const segment_vector<T>& h) noexcept
+    {
+        return { segment_at<T>(base, h.offset), static_cast<std::size_t>(h.size) };
+    }
+
+    template<typename C, class T = std::char_traits<C>, class A = std::allocator<C>>
+    borrowed_string<const C, T, A> rehydrate(const void* base, const segment_string<C>& h)
+    {
+        return borrowed_string<const C, T, A>(segment_at<C>(base, h.offset), static_cast<std::size_t>(h.size));
+    }
+
+    template<typename C, class T = std::char_traits<C>, class A = std::allocator<C>>
+    borrowed_string<C, T, A> rehydrate(void* base, const segment_string<C>& h)
+    {
+        return borrowed_string<C, T, A>(segment_at<C>(base, h.offset), static_cast<std::size_t>(h.size));
+    }
+}
+
+#endif
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_SERIALIZE_HPP
+#define UNSAFE_SERIALIZE_HPP
+
+#include <array>
+#include <cstring>
+#include <memory>
+
+#include "bind.hpp"
+
+namespace unsafe
+{
+    // A byte range of an object covering adjacent fields.
+    struct field_run
+    {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    // The fields of C merged into runs wherever one starts right where the previous ends,
+    // as {runs, number of runs}.
+    template<class C, int... I>
+    constexpr auto field_runs(std::integer_sequence<int, I...>)
+    {
+        constexpr std::size_t offset[] = { field_t<C, I>::offset... };
+        constexpr std::size_t size[] = { field_t<C, I>::size... };
+
+        std::array<field_run, sizeof...(I)> runs{};
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < sizeof...(I); ++i)
+        {
+            if (n > 0 && runs[n - 1].offset + runs[n - 1].size == offset[i])
+                runs[n - 1].size += size[i];
+            else
+                runs[n++] = { offset[i], size[i] };
+        }
+        return std::pair{ runs, n };
+    }
+
+    template<class C>
+    constexpr auto field_runs()
+    {
+        return field_runs<C>(std::make_integer_sequence<int, fields<C>::count>{});
+    }
+
+    // Bytes written by serialize: the fields back to back, without padding.
+    template<class C, int... I>
+    constexpr std::size_t serialized_size(std::integer_sequence<int, I...>) noexcept
+    {
+        return (field_t<C, I>::size + ...);
+    }
+
+    template<class C>
+    constexpr std::size_t serialized_size() noexcept
+    {
+        return serialized_size<C>(std::make_integer_sequence<int, fields<C>::count>{});
+    }
+
+    template<class C, int... I>
+    constexpr bool trivially_serializable(std::integer_sequence<int, I...>) noexcept
+    {
+        return (std::is_trivially_copyable_v<typename field_t<C, I>::type> && ...);
+    }
+
+    template<class C, std::size_t... R>
+    char* serialize(const C& obj, char* out, std::index_sequence<R...>) noexcept
+    {
+        constexpr auto runs = field_runs<C>().first;
+        const char* p = reinterpret_cast<const char*>(std::addressof(obj));
+        ((std::memcpy(out, p + runs[R].offset, runs[R].size), out += runs[R].size), ...);
+        return out;
+    }
+
+    template<class C, std::size_t... R>
+    const char* deserialize(C& obj, const char* in, std::index_sequence<R...>) noexcept
+    {
+        constexpr auto runs = field_runs<C>().first;
+        char* p = reinterpret_cast<char*>(std::addressof(obj));
+        ((std::memcpy(p + runs[R].offset, in, runs[R].size), in += runs[R].size), ...);
+        return in;
+    }
+
+    // Writes the fields of obj, declared by UNSAFE_FIELDS, to out, which must have room
+    // for serialized_size<C>() bytes, with one memcpy per run of adjacent fields.
+    // Returns the end of the written bytes. The fields must be trivially copyable.
+    template<class C>
+    char* serialize(const C& obj, char* out) noexcept
+    {
+        static_assert(trivially_serializable<C>(std::make_integer_sequence<int, fields<C>::count>{}),
+                      "fields must be trivially copyable");
+        return serialize(obj, out, std::make_index_sequence<field_runs<C>().second>{});
+    }
+
+    // Reads back the fields written by serialize and returns the end of the bytes read.
+    template<class C>
+    const char* deserialize(C& obj, const char* in) noexcept
+    {
+        static_assert(trivially_serializable<C>(std::make_integer_sequence<int, fields<C>::count>{}),
+                      "fields must be trivially copyable");
+        return deserialize(obj, in, std::make_index_sequence<field_runs<C>().second>{});
+    }
+}
+
+#endif
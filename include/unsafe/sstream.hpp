@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_SSTREAM_HPP
+#define UNSAFE_SSTREAM_HPP
+
+#include <sstream>
+#include <climits> // INT_MAX
+
+#include "bind.hpp"
+#include "string.hpp"
+
+#if defined(_LIBCPP_VERSION)
+// https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/include/sstream#L255-L257
+UNSAFE_BIND(std::stringbuf, ~0, __str_);
+UNSAFE_BIND(std::wstringbuf, ~0, __str_);
+UNSAFE_BIND(std::stringbuf, ~1, __hm_);
+UNSAFE_BIND(std::wstringbuf, ~1, __hm_);
+UNSAFE_BIND(std::stringbuf, ~2, __mode_);
+UNSAFE_BIND(std::wstringbuf, ~2, __mode_);
+#endif
+
+namespace unsafe
+{
+    template<class CharT, class Traits, class Alloc>
+    struct stringbuf_access : std::basic_stringbuf<CharT, Traits, Alloc>
+    {
+        using string_type = std::basic_string<CharT, Traits, Alloc>;
+        using std::basic_stringbuf<CharT, Traits, Alloc>::eback;
+        using std::basic_stringbuf<CharT, Traits, Alloc>::gptr;
+        using std::basic_stringbuf<CharT, Traits, Alloc>::pbase;
+        using std::basic_stringbuf<CharT, Traits, Alloc>::pptr;
+
+        static stringbuf_access& from(std::basic_stringbuf<CharT, Traits, Alloc>& buf) noexcept
+        {
+            return static_cast<stringbuf_access&>(buf);
+        }
+
+#if defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI
+        // https://github.com/gcc-mirror/gcc/blob/releases/gcc-13.2.0/libstdc++-v3/include/std/sstream#L98-L103
+        string_type& string() noexcept { return this->_M_string; }
+
+        // Characters are written past the length of the string, up to its capacity.
+        void sync_length() noexcept
+        {
+            if (CharT* pptr = this->pptr())
+            {
+                CharT* hi = this->egptr() > pptr ? this->egptr() : pptr;
+                reinterpret_cast<basic_string<CharT, Traits, Alloc>&>(string()).length(hi - this->pbase());
+                Traits::assign(*hi, CharT());
+            }
+        }
+
+        void init() { this->_M_stringbuf_init(this->_M_mode); }
+        void sync(std::size_t i, std::size_t o) { this->_M_sync(const_cast<CharT*>(string().data()), i, o); }
+#elif defined(_LIBCPP_VERSION)
+        string_type& string() noexcept { return unsafe::get<~0>(static_cast<std::basic_stringbuf<CharT, Traits, Alloc>&>(*this)); }
+        CharT*& high_mark() noexcept { return unsafe::get<~1>(static_cast<std::basic_stringbuf<CharT, Traits, Alloc>&>(*this)); }
+        std::ios_base::openmode mode() noexcept { return unsafe::get<~2>(static_cast<std::basic_stringbuf<CharT, Traits, Alloc>&>(*this)); }
+
+        // The string is resized to its capacity while writing, and the high mark tracks the end.
+        void sync_length()
+        {
+            if (CharT* pptr = this->pptr())
+            {
+                if (high_mark() < pptr) high_mark() = pptr;
+                string().resize(high_mark() - this->pbase());
+            }
+        }
+
+        void init() { sync(0, mode() & (std::ios_base::app | std::ios_base::ate) ? string().size() : 0); }
+
+        // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/include/sstream#L432-L455
+        void sync(std::size_t i, std::size_t o)
+        {
+            CharT* data = const_cast<CharT*>(string().data());
+            const std::size_t size = string().size();
+            high_mark() = data + size;
+            if (mode() & std::ios_base::in)
+                this->setg(data, data + i, data + size);
+            if (mode() & std::ios_base::out)
+            {
+                string().resize(string().capacity());
+                data = const_cast<CharT*>(string().data());
+                high_mark() = data + size;
+                this->setp(data, data + string().size());
+                for (; o > INT_MAX; o -= INT_MAX) this->pbump(INT_MAX);
+                this->pbump(static_cast<int>(o));
+            }
+        }
+#endif
+
+        // Whether the buffer is the string, i.e. not replaced by pubsetbuf.
+        bool owned() noexcept
+        {
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+            // An output-only libstdc++ stringbuf keeps an empty get area at the end.
+            const CharT* data = string().data();
+            return (!this->pbase() || this->pbase() == data) &&
+                (!this->eback() || (this->eback() >= data && this->eback() <= data + string().capacity()));
+#else
+            return false;
+#endif
+        }
+    };
+
+    // Moves the contents out of a stringbuf without copying and leaves it empty, like the
+    // C++20 std::move(buf).str(). Copies on MSVC, whose stringbuf holds no string.
+    template<class CharT, class Traits, class Alloc>
+    std::basic_string<CharT, Traits, Alloc> release(std::basic_stringbuf<CharT, Traits, Alloc>& buf)
+    {
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+        auto& a = stringbuf_access<CharT, Traits, Alloc>::from(buf);
+        if (a.owned())
+        {
+            a.sync_length();
+            std::basic_string<CharT, Traits, Alloc> s = std::move(a.string());
+            a.string().clear();
+            a.sync(0, 0);
+            return s;
+        }
+#endif
+
+        std::basic_string<CharT, Traits, Alloc> s = buf.str();
+        buf.str(std::basic_string<CharT, Traits, Alloc>(s.get_allocator()));
+        return s;
+    }
+
+    // Replaces the contents of a stringbuf by s without copying, like the C++20
+    // buf.str(std::move(s)). Copies on MSVC, whose stringbuf holds no string.
+    template<class CharT, class Traits, class Alloc>
+    void adopt(std::basic_stringbuf<CharT, Traits, Alloc>& buf, std::basic_string<CharT, Traits, Alloc>&& s)
+    {
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+        auto& a = stringbuf_access<CharT, Traits, Alloc>::from(buf);
+        a.string() = std::move(s);
+        a.init();
+#else
+        buf.str(s);
+#endif
+    }
+
+    // Grows the buffer so that n characters in total are written without reallocating.
+    // The get and put positions are kept.
+    template<class CharT, class Traits, class Alloc>
+    void reserve(std::basic_stringbuf<CharT, Traits, Alloc>& buf, std::size_t n)
+    {
+        auto& a = stringbuf_access<CharT, Traits, Alloc>::from(buf);
+        if (!a.owned()) return;
+
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+        const std::size_t i = a.gptr() - a.eback();
+        const std::size_t o = a.pptr() - a.pbase();
+        a.sync_length();
+        if (n > a.string().capacity()) a.string().reserve(n);
+        a.sync(i, o);
+#else
+        (void)n;
+#endif
+    }
+}
+
+#endif
@@ -10,6 +10,9 @@
 
 #include <string>
 #include <cstring> // memcpy, memset
+#include <memory> // allocator_traits
+#include <tuple>
+#include <type_traits>
 
 namespace unsafe
 {
@@ -38,6 +41,21 @@ namespace unsafe
         std::size_t length() noexcept { return raw()._Mysize; }
         std::size_t allocated() noexcept { return raw()._Myres; }
 
+        void buffer(C* p) noexcept { raw()._Bx._Ptr = p; }
+        void length(std::size_t n) noexcept { raw()._Mysize = n; }
+        void allocated(std::size_t n) noexcept { raw()._Myres = n; }
+
+        std::size_t local_capacity() noexcept { return std::size(raw()._Bx._Buf) - 1; }
+        bool local() noexcept { return allocated() <= local_capacity(); }
+
+        // Forgets the buffer without freeing it.
+        void reset() noexcept
+        {
+            raw()._Mysize = 0;
+            raw()._Myres = local_capacity();
+            T::assign(raw()._Bx._Buf[0], C());
+        }
+
         basic_string(C* data, std::size_t size, std::size_t capacity = 0) noexcept
         {
             std::memset(this, 0, sizeof *this);
@@ -50,7 +68,8 @@ namespace unsafe
             if (raw()._Myres <= capacity) // see _Myptr()
             {
                 raw()._Myres = capacity;
-                std::memcpy(raw()._Bx._Buf, data, sizeof(C) * (size + 1));
+                std::memcpy(raw()._Bx._Buf, data, sizeof(C) * size); // data[size] may be unreadable
+                T::assign(raw()._Bx._Buf[size], C());
             }
         }
 #elif defined(__GLIBCXX__)
@@ -70,6 +89,21 @@ namespace unsafe
         std::size_t length() noexcept { return raw()._M_string_length; }
         std::size_t allocated() noexcept { return raw()._M_allocated_capacity; }
 
+        void buffer(C* p) noexcept { raw()._M_dataplus._M_p = p; }
+        void length(std::size_t n) noexcept { raw()._M_string_length = n; }
+        void allocated(std::size_t n) noexcept { raw()._M_allocated_capacity = n; }
+
+        std::size_t local_capacity() noexcept { return 15 / sizeof(C); } // _S_local_capacity
+        bool local() noexcept { return buffer() == reinterpret_cast<C*>(&raw()._M_allocated_capacity); }
+
+        // Forgets the buffer without freeing it.
+        void reset() noexcept
+        {
+            buffer(reinterpret_cast<C*>(&raw()._M_allocated_capacity));
+            length(0);
+            T::assign(buffer()[0], C());
+        }
+
         basic_string(C* data, std::size_t size, std::size_t capacity = 0) noexcept
         {
             std::memset(this, 0, sizeof * this);
@@ -83,6 +117,12 @@ namespace unsafe
         C* buffer() noexcept;
         std::size_t length() noexcept;
         std::size_t allocated() noexcept;
+        void buffer(C* p) noexcept;
+        void length(std::size_t n) noexcept;
+        void allocated(std::size_t n) noexcept;
+        std::size_t local_capacity() noexcept;
+        bool local() noexcept;
+        void reset() noexcept;
         basic_string(C* data, std::size_t size, std::size_t capacity = 0) noexcept;
 #endif
 
@@ -90,8 +130,150 @@ namespace unsafe
         basic_string() noexcept : basic_string(nullptr, 0, 0) {}
         basic_string(std::basic_string<C, T, A>& s) noexcept : basic_string(s.data(), s.size(), s.capacity()) {}
         operator std::basic_string<C, T, A>&() noexcept { return s; }
+
+        // Backport of C++23 resize_and_overwrite(n, op). op(buffer(), n) overwrites
+        // the contents without zero-filling first and returns the new length r <= n.
+        template<class Op>
+        void resize_and_overwrite(std::size_t n, Op op)
+        {
+            if (n > s.capacity()) s.reserve(n);
+            const std::size_t r = std::move(op)(buffer(), n);
+            length(r);
+            T::assign(buffer()[r], C());
+        }
+
+        // Detaches the buffer and leaves the string empty. The caller owns the returned
+        // {data, size, capacity}, allocated by the string's allocator for capacity + 1
+        // elements and null-terminated. An SSO string is copied into a new allocation.
+        std::tuple<C*, std::size_t, std::size_t> release()
+        {
+            const std::size_t size = length();
+            if (local())
+            {
+                A a = s.get_allocator();
+                C* p = std::allocator_traits<A>::allocate(a, size + 1);
+                T::copy(p, buffer(), size + 1);
+                reset();
+                return { p, size, size };
+            }
+
+            std::tuple<C*, std::size_t, std::size_t> r(buffer(), size, allocated());
+            reset();
+            return r;
+        }
+
+        // Destroys the current contents and takes ownership of data, which is allocated
+        // by the string's allocator for capacity + 1 elements. data[size] is overwritten
+        // by the terminator. Contents fitting in SSO are copied and data is deallocated.
+        void adopt(C* data, std::size_t size, std::size_t capacity)
+        {
+            if (capacity < size) capacity = size;
+            std::basic_string<C, T, A>(s.get_allocator()).swap(s);
+
+            if (capacity <= local_capacity())
+            {
+                T::copy(buffer(), data, size);
+                A a = s.get_allocator();
+                std::allocator_traits<A>::deallocate(a, data, capacity + 1);
+            }
+            else
+            {
+                buffer(data);
+                allocated(capacity);
+            }
+
+            length(size);
+            T::assign(buffer()[size], C());
+        }
     };
 
+    // Presents external characters as a std::basic_string without copying. The string
+    // may be read but must not change size or capacity. Characters borrowed as const C
+    // are only presented as a const std::basic_string. On destruction the header is
+    // cleared, so the allocator never frees the memory. Since a std::basic_string is
+    // always null-terminated, the characters are copied when no terminator can be
+    // provided, and on MSVC when they fit in SSO.
+    template<typename C, class T = std::char_traits<std::remove_const_t<C>>, class A = std::allocator<std::remove_const_t<C>>>
+    class borrowed_string
+    {
+        using char_type = std::remove_const_t<C>;
+        using string_type = std::conditional_t<std::is_const_v<C>, const std::basic_string<char_type, T, A>, std::basic_string<char_type, T, A>>;
+
+        basic_string<char_type, T, A> us;
+        std::basic_string<char_type, T, A> copy;
+        std::basic_string<char_type, T, A>* str = &us.s;
+        char_type* terminator = nullptr;
+        char_type saved = char_type();
+
+    public:
+        // s must be null-terminated.
+        explicit borrowed_string(C* s) noexcept : us(const_cast<char_type*>(s), T::length(s)) {}
+
+        // data[size] must be readable; the characters are copied if it is not a terminator.
+        borrowed_string(C* data, std::size_t size) : us(const_cast<char_type*>(data), size)
+        {
+            if (!T::eq(data[size], char_type()))
+            {
+                copy.assign(data, size);
+                str = &copy;
+            }
+        }
+
+        // data[size] is overwritten by a terminator if capacity > size, and restored on
+        // destruction; otherwise the characters are copied.
+        borrowed_string(char_type* data, std::size_t size, std::size_t capacity) : us(data, size)
+        {
+            if (capacity > size)
+            {
+                terminator = data + size;
+                T::assign(saved, *terminator);
+                T::assign(*terminator, char_type());
+            }
+            else
+            {
+                copy.assign(data, size);
+                str = &copy;
+            }
+        }
+
+        borrowed_string(const borrowed_string&) = delete;
+        borrowed_string& operator=(const borrowed_string&) = delete;
+
+        ~borrowed_string()
+        {
+            us.reset();
+            us.s.~basic_string();
+            if (terminator) T::assign(*terminator, saved);
+        }
+
+        string_type& get() noexcept { return *str; }
+        const std::basic_string<char_type, T, A>& get() const noexcept { return *str; }
+        operator string_type&() noexcept { return *str; }
+        operator const std::basic_string<char_type, T, A>&() const noexcept { return *str; }
+    };
+
+    template<typename C, class T, class A, class Op>
+    void resize_and_overwrite(std::basic_string<C, T, A>& s, std::size_t n, Op op)
+    {
+#ifdef __cpp_lib_string_resize_and_overwrite
+        s.resize_and_overwrite(n, std::move(op));
+#else
+        reinterpret_cast<basic_string<C, T, A>&>(s).resize_and_overwrite(n, std::move(op));
+#endif
+    }
+
+    template<typename C, class T, class A>
+    std::tuple<C*, std::size_t, std::size_t> release(std::basic_string<C, T, A>& s)
+    {
+        return reinterpret_cast<basic_string<C, T, A>&>(s).release();
+    }
+
+    template<typename C, class T, class A>
+    void adopt(std::basic_string<C, T, A>& s, C* data, std::size_t size, std::size_t capacity)
+    {
+        reinterpret_cast<basic_string<C, T, A>&>(s).adopt(data, size, capacity);
+    }
+
     using string = basic_string<char>;
     using wstring = basic_string<wchar_t>;
     using u16string = basic_string<char16_t>;
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2023 Huang Qinjin (huangqinjin@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef UNSAFE_TRANSFER_HPP
+#define UNSAFE_TRANSFER_HPP
+
+#include <type_traits>
+
+#include "vector.hpp"
+#include "string.hpp"
+
+namespace unsafe
+{
+    template<class A1, class A2>
+    bool same_allocator(const A1& a1, const A2& a2) noexcept
+    {
+        if constexpr (std::is_same_v<A1, A2>)
+            return a1 == a2;
+        else
+            return false;
+    }
+
+    // Moves the contents of a vector into a string, leaving the vector empty.
+    // The heap buffer is handed over in O(1) when the allocators are equal and
+    // the vector has room for the terminator; small contents are copied into SSO.
+    template<typename C, class T, class A1, class A2>
+    void transfer(std::vector<C, A1>& from, std::basic_string<C, T, A2>& to)
+    {
+        auto& v = reinterpret_cast<vector<C, A1>&>(from);
+        auto& s = reinterpret_cast<basic_string<C, T, A2>&>(to);
+
+        const std::size_t size = v.finish() - v.start();
+        const std::size_t capacity = v.storage() - v.start();
+
+        if (size > s.local_capacity() && size < capacity &&
+            same_allocator(from.get_allocator(), to.get_allocator()))
+        {
+            auto [p, n, c] = v.release();
+            s.adopt(p, n, c - 1);
+        }
+        else
+        {
+            to.assign(from.data(), size);
+            from.clear();
+        }
+    }
+
+    // Moves the contents of a string into a vector, leaving the string empty.
+    // The heap buffer is handed over in O(1) when the allocators are equal and
+    // the string is not in SSO mode; the terminator slot becomes spare capacity.
+    template<typename C, class T, class A1, class A2>
+    void transfer(std::basic_string<C, T, A1>& from, std::vector<C, A2>& to)
+    {
+        auto& s = reinterpret_cast<basic_string<C, T, A1>&>(from);
+        auto& v = reinterpret_cast<vector<C, A2>&>(to);
+
+        if (!s.local() && same_allocator(from.get_allocator(), to.get_allocator()))
+        {
+            auto [p, n, c] = s.release();
+            v.adopt(p, n, c + 1);
+        }
+        else
+        {
+            to.assign(from.begin(), from.end());
+            from.clear();
+        }
+    }
+}
+
+#endif
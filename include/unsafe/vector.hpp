@@ -9,10 +9,44 @@
 #define UNSAFE_VECTOR_HPP
 
 #include <vector>
+#include <climits> // CHAR_BIT
 #include <cstring> // memcpy, memset
+#include <cstddef> // max_align_t
+#include <cstdlib> // malloc, realloc, free
+#include <new> // bad_alloc
+#include <stdexcept> // length_error
+#include <type_traits>
+#include <tuple>
 
 namespace unsafe
 {
+    // Allocator drawing from malloc, whose vectors unsafe::reserve grows with realloc.
+    template<typename T>
+    struct malloc_allocator
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "T is over-aligned for malloc");
+
+        using value_type = T;
+
+        malloc_allocator() noexcept = default;
+        template<typename U>
+        malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n)
+        {
+            if (n > std::size_t(-1) / sizeof(T)) throw std::bad_alloc();
+            if (void* p = std::malloc(n == 0 ? 1 : n * sizeof(T))) return static_cast<T*>(p);
+            throw std::bad_alloc();
+        }
+
+        void deallocate(T* p, std::size_t) noexcept { std::free(p); }
+
+        template<typename U>
+        bool operator==(const malloc_allocator<U>&) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const malloc_allocator<U>&) const noexcept { return false; }
+    };
+
     template<typename T, class A = std::allocator<T>>
     union vector
     {
@@ -38,6 +72,10 @@ namespace unsafe
         T* finish() noexcept { return raw()._Mylast; }
         T* storage() noexcept { return raw()._Myend; }
 
+        void start(T* p) noexcept { raw()._Myfirst = p; }
+        void finish(T* p) noexcept { raw()._Mylast = p; }
+        void storage(T* p) noexcept { raw()._Myend = p; }
+
         vector(T* data, std::size_t size, std::size_t capacity = 0) noexcept
         {
             std::memset(this, 0, sizeof *this);
@@ -59,6 +97,10 @@ namespace unsafe
         T* finish() noexcept { return raw()._M_finish; }
         T* storage() noexcept { return raw()._M_end_of_storage; }
 
+        void start(T* p) noexcept { raw()._M_start = p; }
+        void finish(T* p) noexcept { raw()._M_finish = p; }
+        void storage(T* p) noexcept { raw()._M_end_of_storage = p; }
+
         vector(T* data, std::size_t size, std::size_t capacity = 0) noexcept
         {
             std::memset(this, 0, sizeof *this);
@@ -78,6 +120,10 @@ namespace unsafe
         T* finish() noexcept { return raw()[1]; }
         T* storage() noexcept { return raw()[2]; }
 
+        void start(T* p) noexcept { raw()[0] = p; }
+        void finish(T* p) noexcept { raw()[1] = p; }
+        void storage(T* p) noexcept { raw()[2] = p; }
+
         vector(T* data, std::size_t size, std::size_t capacity = 0) noexcept
         {
             std::memset(this, 0, sizeof *this);
@@ -90,6 +136,9 @@ namespace unsafe
         T* start() noexcept;
         T* finish() noexcept;
         T* storage() noexcept;
+        void start(T* p) noexcept;
+        void finish(T* p) noexcept;
+        void storage(T* p) noexcept;
         vector(T* data, std::size_t size, std::size_t capacity = 0) noexcept;
 #endif
  
@@ -97,8 +146,230 @@ namespace unsafe
         vector() noexcept : vector(nullptr, 0, 0) {}
         vector(std::vector<T, A>& v) noexcept : vector(v.data(), v.size(), v.capacity()) {}
         operator std::vector<T, A>&() noexcept { return v; }
+
+        // realloc may only grow memory that came from malloc, as malloc_allocator does.
+        // std::allocator gets it from ::operator new, which is malloc only unless the program
+        // or a sanitizer replaces it, so it is grown by realloc only if UNSAFE_VECTOR_REALLOC
+        // is defined by a program that knows it is not.
+        static constexpr bool reallocatable = std::is_trivially_copyable_v<T> &&
+            (std::is_same_v<A, malloc_allocator<T>>
+#if (defined(__GLIBCXX__) || defined(_LIBCPP_VERSION)) && defined(UNSAFE_VECTOR_REALLOC)
+             || (std::is_same_v<A, std::allocator<T>> && alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+#endif
+            );
+
+        // Like v.reserve(n), but grows through realloc when T is trivially copyable and A
+        // is malloc_allocator, so the block can be extended in place and, with glibc, large
+        // blocks are moved by mremap instead of being copied while both are resident.
+        void reserve(std::size_t n)
+        {
+            if constexpr (reallocatable)
+            {
+                if (n <= std::size_t(storage() - start())) return;
+                if (n > v.max_size()) throw std::length_error("unsafe::vector::reserve");
+
+                const std::size_t size = finish() - start();
+                T* p = static_cast<T*>(std::realloc(start(), n * sizeof(T)));
+                if (p == nullptr) throw std::bad_alloc();
+
+                start(p);
+                finish(p + size);
+                storage(p + n);
+            }
+            else
+            {
+                v.reserve(n);
+            }
+        }
+
+        // Like resize(n), but the new elements are left uninitialized and must be
+        // written before being read. Grows geometrically through reserve().
+        T* resize_uninitialized(std::size_t n)
+        {
+            static_assert(std::is_trivially_default_constructible_v<T> &&
+                          std::is_trivially_destructible_v<T>,
+                          "T must be trivially default constructible and destructible");
+
+            const std::size_t size = finish() - start();
+            if (n > std::size_t(storage() - start()))
+                reserve(n < 2 * size ? 2 * size : n);
+
+            finish(start() + n);
+            return start();
+        }
+
+        // Appends n uninitialized elements and returns a pointer to the first one.
+        T* append_uninitialized(std::size_t n)
+        {
+            const std::size_t size = finish() - start();
+            return resize_uninitialized(size + n) + size;
+        }
+
+        // Detaches the buffer and leaves the vector empty. The caller owns the returned
+        // {data, size, capacity} and must destroy and deallocate it through the allocator.
+        std::tuple<T*, std::size_t, std::size_t> release() noexcept
+        {
+            std::tuple<T*, std::size_t, std::size_t> r(start(), finish() - start(), storage() - start());
+            start(nullptr);
+            finish(nullptr);
+            storage(nullptr);
+            return r;
+        }
+
+        // Destroys the current contents and takes ownership of data, which is allocated
+        // by the vector's allocator for capacity elements with the first size constructed.
+        void adopt(T* data, std::size_t size, std::size_t capacity) noexcept
+        {
+            std::vector<T, A>(v.get_allocator()).swap(v);
+            start(data);
+            finish(data + size);
+            storage(data + (capacity < size ? size : capacity));
+        }
+    };
+
+    // std::vector<bool> packs the bits into an array of words, bit i being bit i % word_bits
+    // of word i / word_bits. The bits past size() in the last word are unspecified.
+    template<class A>
+    union vector<bool, A>
+    {
+        std::vector<bool, A> v;
+        unsigned char header[sizeof(std::vector<bool, A>)];
+
+#if defined(_MSVC_STL_UPDATE)
+        // https://github.com/microsoft/STL/blob/vs-2022-17.9/stl/inc/vector#L2373-L2374
+        using word_type = std::_Vbase;
+
+        auto& raw() noexcept
+        {
+            return static_cast<std::_Vb_val<A>&>(v);
+        }
+
+        word_type* words() noexcept { return raw()._Myvec.data(); }
+        std::size_t size() noexcept { return raw()._Mysize; }
+#elif defined(__GLIBCXX__)
+        // https://github.com/gcc-mirror/gcc/blob/releases/gcc-13.2.0/libstdc++-v3/include/bits/stl_bvector.h#L489-L504
+        using word_type = std::_Bit_type;
+
+        auto& raw() noexcept
+        {
+            struct S : std::_Bvector_base<A>::_Bit_alloc_type
+            {
+                std::_Bit_iterator _M_start;
+                std::_Bit_iterator _M_finish;
+                word_type* _M_end_of_storage;
+            };
+            static_assert(sizeof(S) == sizeof(std::vector<bool, A>));
+            return reinterpret_cast<S&>(v);
+        }
+
+        word_type* words() noexcept { return raw()._M_start._M_p; }
+        std::size_t size() noexcept { return (raw()._M_finish._M_p - words()) * word_bits + raw()._M_finish._M_offset; }
+#elif defined(_LIBCPP_VERSION)
+        // https://github.com/llvm/llvm-project/blob/llvmorg-17.0.1/libcxx/include/__bit_reference#L1053-L1055
+        using word_type = typename std::allocator_traits<A>::size_type;
+
+        auto& raw() noexcept
+        {
+            struct S
+            {
+                word_type* __begin_;
+                word_type __size_;
+            };
+            return reinterpret_cast<S&>(v);
+        }
+
+        word_type* words() noexcept { return raw().__begin_; }
+        std::size_t size() noexcept { return raw().__size_; }
+#else
+        using word_type = unsigned long;
+        word_type* words() noexcept;
+        std::size_t size() noexcept;
+#endif
+
+        static constexpr std::size_t word_bits = sizeof(word_type) * CHAR_BIT;
+
+        ~vector() {}
+        // Copies the header of v, not its words, to be read through the member v.
+        vector(std::vector<bool, A>& v) noexcept : header() { std::memcpy(header, &v, sizeof header); }
+        operator std::vector<bool, A>&() noexcept { return v; }
+
+        std::size_t word_count() noexcept { return (size() + word_bits - 1) / word_bits; }
+    };
+
+    // Presents external memory as a std::vector without copying. The vector may be
+    // read or have its elements modified but must not change size or capacity.
+    // Memory borrowed as const T is only presented as a const std::vector.
+    // On destruction the header is cleared, so the allocator never frees the memory.
+    template<typename T, class A = std::allocator<std::remove_const_t<T>>>
+    class borrowed_vector
+    {
+        using value_type = std::remove_const_t<T>;
+        using vector_type = std::conditional_t<std::is_const_v<T>, const std::vector<value_type, A>, std::vector<value_type, A>>;
+
+        vector<value_type, A> uv;
+
+    public:
+        borrowed_vector(T* data, std::size_t size) noexcept : uv(const_cast<value_type*>(data), size, size) {}
+        borrowed_vector(const borrowed_vector&) = delete;
+        borrowed_vector& operator=(const borrowed_vector&) = delete;
+
+        ~borrowed_vector()
+        {
+            uv.start(nullptr);
+            uv.finish(nullptr);
+            uv.storage(nullptr);
+            uv.v.~vector();
+        }
+
+        vector_type& get() noexcept { return uv.v; }
+        const std::vector<value_type, A>& get() const noexcept { return uv.v; }
+        operator vector_type&() noexcept { return uv.v; }
+        operator const std::vector<value_type, A>&() const noexcept { return uv.v; }
     };
 
+    template<typename T, class A>
+    void reserve(std::vector<T, A>& v, std::size_t n)
+    {
+        reinterpret_cast<vector<T, A>&>(v).reserve(n);
+    }
+
+    template<typename T, class A>
+    T* resize_uninitialized(std::vector<T, A>& v, std::size_t n)
+    {
+        return reinterpret_cast<vector<T, A>&>(v).resize_uninitialized(n);
+    }
+
+    template<typename T, class A>
+    T* append_uninitialized(std::vector<T, A>& v, std::size_t n)
+    {
+        return reinterpret_cast<vector<T, A>&>(v).append_uninitialized(n);
+    }
+
+    template<typename T, class A>
+    std::tuple<T*, std::size_t, std::size_t> release(std::vector<T, A>& v) noexcept
+    {
+        return reinterpret_cast<vector<T, A>&>(v).release();
+    }
+
+    template<typename T, class A>
+    void adopt(std::vector<T, A>& v, T* data, std::size_t size, std::size_t capacity) noexcept
+    {
+        reinterpret_cast<vector<T, A>&>(v).adopt(data, size, capacity);
+    }
+
+    template<class A>
+    auto words(std::vector<bool, A>& v) noexcept
+    {
+        return reinterpret_cast<vector<bool, A>&>(v).words();
+    }
+
+    template<class A>
+    auto words(const std::vector<bool, A>& v) noexcept
+    {
+        return const_cast<const typename vector<bool, A>::word_type*>(
+            reinterpret_cast<vector<bool, A>&>(const_cast<std::vector<bool, A>&>(v)).words());
+    }
+
 #ifdef __cpp_lib_memory_resource
     namespace pmr
     {
@@ -2,6 +2,9 @@
 
 #include <unsafe/bind.hpp>
 
+#include <tuple>
+#include <vector>
+
 namespace
 {
     class B
@@ -19,6 +22,48 @@ namespace
     };
 }
 
+namespace
+{
+    struct M
+    {
+        int f(int, long) const& noexcept;
+        void g(int, ...) &&;
+        char h() volatile;
+        int d[2];
+    };
+}
+
+TEST_CASE("mem_fn_t")
+{
+    using F = unsafe::mem_fn_t<decltype(&M::f)>;
+    static_assert(std::is_same_v<F::ret, int>);
+    static_assert(std::is_same_v<F::cls, M>);
+    static_assert(std::is_same_v<F::obj, const M&>);
+    static_assert(std::is_same_v<F::type, int(int, long) const& noexcept>);
+    static_assert(std::is_same_v<F::cvr<M>, const M&>);
+    static_assert(std::is_same_v<F::args<std::tuple>, std::tuple<int, long>>);
+    static_assert(std::is_same_v<F::args<std::tuple, std::add_pointer>, std::tuple<int*, long*>>);
+    static_assert(std::is_same_v<F::argt<std::common_type>, long>);
+    static_assert(F::argv<std::is_same> == false);
+    static_assert(!F::var && F::noe && F::argc == 2);
+
+    using G = unsafe::mem_fn_t<decltype(&M::g)>;
+    static_assert(std::is_same_v<G::obj, M&&>);
+    static_assert(std::is_same_v<G::type, void(int, ...) &&>);
+    static_assert(G::var && !G::noe && G::argc == 1);
+
+    using H = unsafe::mem_fn_t<decltype(&M::h)>;
+    static_assert(std::is_same_v<H::obj, volatile M&>);
+    static_assert(std::is_same_v<H::cvr<M>, volatile M>);
+    static_assert(H::argc == 0);
+
+    using D = unsafe::mem_fn_t<decltype(&M::d)>;
+    static_assert(std::is_same_v<D::ret, int[2]>);
+    static_assert(std::is_same_v<D::type, int[2]>);
+    static_assert(std::is_same_v<D::obj, M&>);
+    static_assert(!D::var && !D::noe && D::argc == 0);
+}
+
 UNSAFE_BIND(B, 0, x)
 UNSAFE_BIND_T(B, 1, f, int (B::*)())
 UNSAFE_BIND_T(B, 2, f, int (B::*)() const)
@@ -43,3 +88,114 @@ TEST_CASE("bind")
     CHECK(unsafe::get<1>(d)() == 4321);
     CHECK(unsafe::get<2>(std::move(d))() == -4321);
 }
+
+TEST_CASE("member_function")
+{
+    static_assert(std::is_same_v<decltype(unsafe::member_pointer<B, 0>), int B::* const>);
+    static_assert(std::is_same_v<decltype(unsafe::member_pointer<D, 2>), int (D::* const)() &&>);
+
+    constexpr auto f = unsafe::member_function<B, 1>;
+    constexpr auto cf = unsafe::member_function<B, 2>;
+    constexpr auto g = unsafe::member_function<D, 1>;
+    constexpr auto rg = unsafe::member_function<D, 2>;
+    static_assert(std::is_same_v<decltype(f), int (* const)(B&)>);
+    static_assert(std::is_same_v<decltype(cf), int (* const)(const B&)>);
+    static_assert(std::is_same_v<decltype(g), int (* const)(D&)>);
+    static_assert(std::is_same_v<decltype(rg), int (* const)(D&&)>);
+
+    struct N
+    {
+        int v = 3;
+        long add(int a, long&& b) const noexcept { return v + a + b; }
+    };
+    constexpr auto add = unsafe::invoker<&N::add>::function;
+    static_assert(std::is_same_v<decltype(add), long (* const)(const N&, int, long&&) noexcept>);
+
+    D d;
+    CHECK(unsafe::member_function<B, 0 + 1>(d) == 1234);
+    CHECK(cf(d) == -1234);
+    CHECK(g(d) == 4321);
+    CHECK(rg(std::move(d)) == -4321);
+    CHECK(add(N{}, 1, 2L) == 6);
+    CHECK(d.*unsafe::member_pointer<B, 0> == 1234);
+}
+
+namespace
+{
+    class P
+    {
+        char a = 'a';
+        int b = 2;
+    public:
+        double c = 3.5;
+    };
+}
+
+UNSAFE_FIELDS(P, a, b, c)
+
+TEST_CASE("fields")
+{
+    static_assert(unsafe::fields<P>::count == 3);
+    static_assert(std::is_same_v<unsafe::field_t<P, 0>::type, char>);
+    static_assert(std::is_same_v<unsafe::field_t<P, 1>::type, int>);
+    static_assert(std::is_same_v<unsafe::field_t<P, 2>::type, double>);
+    static_assert(unsafe::field_t<P, 0>::offset == 0);
+    static_assert(unsafe::field_t<P, 1>::offset == alignof(int));
+    static_assert(unsafe::field_t<P, 2>::offset == alignof(double));
+    static_assert(unsafe::field_t<P, 2>::pointer == &P::c);
+
+    P p;
+    CHECK(unsafe::get<0>(p) == 'a');
+    CHECK(unsafe::get<1>(p) == 2);
+    CHECK(unsafe::get<2>(p) == 3.5);
+    CHECK(&(p.*unsafe::field_t<P, 1>::pointer) == &unsafe::get<1>(p));
+    CHECK(reinterpret_cast<char*>(&unsafe::get<1>(p)) - reinterpret_cast<char*>(&p) == unsafe::field_t<P, 1>::offset);
+    CHECK(reinterpret_cast<char*>(&p.c) - reinterpret_cast<char*>(&p) == unsafe::field_t<P, 2>::offset);
+}
+
+namespace
+{
+    class W
+    {
+        int x = 1;
+        int next(int k) noexcept { return x = x * 31 + k; }
+    public:
+        int call(int k) noexcept { return next(k); }
+    };
+}
+
+UNSAFE_BIND(W, 0, next)
+
+TEST_CASE("member_function benchmark", "[.benchmark]")
+{
+    constexpr int n = 1 << 20;
+    std::vector<W> v(16);
+
+    BENCHMARK("direct call")
+    {
+        int s = 0;
+        for (int i = 0; i < n; ++i) s += v[i & 15].call(i);
+        return s;
+    };
+
+    BENCHMARK("unsafe::get<i>(obj)(args)")
+    {
+        int s = 0;
+        for (int i = 0; i < n; ++i) s += unsafe::get<0>(v[i & 15])(i);
+        return s;
+    };
+
+    BENCHMARK("unsafe::member_function<C, i>")
+    {
+        int s = 0;
+        for (int i = 0; i < n; ++i) s += unsafe::member_function<W, 0>(v[i & 15], i);
+        return s;
+    };
+
+    BENCHMARK("obj.*unsafe::member_pointer<C, i>")
+    {
+        int s = 0;
+        for (int i = 0; i < n; ++i) s += (v[i & 15].*unsafe::member_pointer<W, 0>)(i);
+        return s;
+    };
+}
@@ -0,0 +1,137 @@
+#include "catch.hpp"
+
+#include <unsafe/bitset.hpp>
+
+#include <functional>
+#include <random>
+
+namespace
+{
+    std::vector<bool> random_bits(std::size_t n, unsigned seed, double p = 0.5)
+    {
+        std::mt19937 gen(seed);
+        std::bernoulli_distribution d(p);
+        std::vector<bool> v(n);
+        for (std::size_t i = 0; i < n; ++i) v[i] = d(gen);
+        return v;
+    }
+
+    std::size_t count_proxy(const std::vector<bool>& v)
+    {
+        std::size_t n = 0;
+        for (bool b : v) n += b;
+        return n;
+    }
+
+    std::size_t find_proxy(const std::vector<bool>& v, std::size_t pos)
+    {
+        for (; pos < v.size(); ++pos)
+            if (v[pos]) break;
+        return pos < v.size() ? pos : v.size();
+    }
+}
+
+TEST_CASE("vector<bool>")
+{
+    std::vector<bool> v(200);
+    v[0] = v[64] = v[199] = true;
+
+    unsafe::vector uv(v);
+    CHECK(uv.size() == 200);
+    CHECK(uv.words() == unsafe::words(v));
+    CHECK(uv.word_count() == (200 + uv.word_bits - 1) / uv.word_bits);
+
+    const auto* w = unsafe::words(v);
+    for (std::size_t i = 0; i < v.size(); ++i)
+        CHECK(bool(w[i / uv.word_bits] >> i % uv.word_bits & 1) == v[i]);
+
+    v.resize(3);
+    CHECK(unsafe::vector(v).size() == 3);
+}
+
+TEST_CASE("bitset")
+{
+    std::bitset<130> b;
+    b[0] = b[63] = b[129] = true;
+
+    const auto* w = unsafe::words(b);
+    constexpr std::size_t bits = unsafe::bitset<130>::word_bits;
+    for (std::size_t i = 0; i < b.size(); ++i)
+        CHECK(bool(w[i / bits] >> i % bits & 1) == b[i]);
+
+    CHECK(unsafe::popcount(b) == 3);
+    CHECK(unsafe::find_first(b) == 0);
+    CHECK(unsafe::find_first(b, 1) == 63);
+    CHECK(unsafe::find_first(b, 64) == 129);
+    CHECK(unsafe::find_first(b, 130) == 130);
+
+    std::bitset<130> c;
+    c.set();
+    unsafe::combine(c, c, b, std::bit_xor<>());
+    CHECK(c == ~b);
+    CHECK(c.count() == 127); // The bits past N stay zero.
+}
+
+TEST_CASE("bit algorithms")
+{
+    const std::size_t n = GENERATE(0, 1, 63, 64, 65, 1000, 4096 + 7);
+    CAPTURE(n);
+
+    const std::vector<bool> a = random_bits(n, 1);
+    const std::vector<bool> b = random_bits(n, 2, 0.01);
+
+    CHECK(unsafe::popcount(a) == count_proxy(a));
+    CHECK(unsafe::popcount(b) == count_proxy(b));
+
+    for (std::size_t pos = 0; pos <= n; pos += 1 + pos / 3)
+        CHECK(unsafe::find_first(b, pos) == find_proxy(b, pos));
+
+    // Garbage past size() in the last word must be ignored.
+    std::vector<bool> t = a;
+    t.resize(n / 2);
+    CHECK(unsafe::popcount(t) == count_proxy(t));
+    CHECK(unsafe::find_first(t, n / 4) == find_proxy(t, n / 4));
+
+    std::vector<bool> d(n, true);
+    unsafe::combine(d, a, b, std::bit_and<>());
+    for (std::size_t i = 0; i < n; ++i) CHECK(d[i] == (a[i] && b[i]));
+
+    unsafe::combine(d, a, b, std::bit_or<>());
+    for (std::size_t i = 0; i < n; ++i) CHECK(d[i] == (a[i] || b[i]));
+
+    d = a;
+    d.push_back(true);
+    unsafe::combine(unsafe::words(d), unsafe::words(d), unsafe::words(b), n,
+                    [](auto x, auto y) { return decltype(x)(x & ~y); });
+    for (std::size_t i = 0; i < n; ++i) CHECK(d[i] == (a[i] && !b[i]));
+    CHECK(d[n]);
+}
+
+TEST_CASE("bit algorithms benchmark", "[.benchmark]")
+{
+    const std::size_t n = GENERATE(std::size_t(1) << 12, std::size_t(1) << 20, std::size_t(1) << 26);
+    CAPTURE(n);
+
+    const std::vector<bool> a = random_bits(n, 1);
+    const std::vector<bool> b = random_bits(n, 2);
+    std::vector<bool> sparse(n);
+    sparse[n - 1] = true;
+    std::vector<bool> d(n);
+
+    BENCHMARK("popcount proxy") { return count_proxy(a); };
+    BENCHMARK("unsafe::popcount") { return unsafe::popcount(a); };
+
+    BENCHMARK("bit_and proxy")
+    {
+        for (std::size_t i = 0; i < n; ++i) d[i] = a[i] && b[i];
+        return d.size();
+    };
+    BENCHMARK("unsafe::combine bit_and")
+    {
+        unsafe::combine(d, a, b, std::bit_and<>());
+        return d.size();
+    };
+
+    BENCHMARK("find_first proxy") { return find_proxy(sparse, 0); };
+    BENCHMARK("unsafe::find_first") { return unsafe::find_first(sparse); };
+}
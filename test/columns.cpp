@@ -0,0 +1,141 @@
+#include "catch.hpp"
+
+#include <unsafe/columns.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+namespace
+{
+    // Stands for a record type of a library, with private members.
+    class trade
+    {
+        std::int64_t id = 0;
+        double price = 0;
+        std::int32_t qty = 0;
+        char side = 'B';
+        char venue[11] = {};
+        double fee = 0;
+
+    public:
+        trade() = default;
+        trade(std::int64_t id, double price, std::int32_t qty) : id(id), price(price), qty(qty), fee(price * 1e-4) {}
+        double get_price() const { return price; }
+        std::int32_t get_qty() const { return qty; }
+    };
+
+    std::vector<trade> make_trades(std::size_t n)
+    {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> price(1, 1000);
+        std::uniform_int_distribution<std::int32_t> qty(1, 10000);
+        std::vector<trade> v;
+        v.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) v.emplace_back(std::int64_t(i), price(gen), qty(gen));
+        return v;
+    }
+}
+
+UNSAFE_FIELDS(trade, id, price, qty, side, venue, fee)
+
+TEST_CASE("column_view")
+{
+    std::vector<trade> v = make_trades(100);
+    auto prices = unsafe::column_view<1>(v);
+    static_assert(std::is_same_v<decltype(prices), unsafe::strided_view<double>>);
+    CHECK(prices.size() == v.size());
+    CHECK(prices.stride_bytes() == sizeof(trade));
+    CHECK(prices.end() - prices.begin() == 100);
+
+    for (std::size_t i = 0; i < v.size(); ++i) CHECK(prices[i] == v[i].get_price());
+    CHECK(*std::max_element(prices.begin(), prices.end()) ==
+          std::max_element(v.begin(), v.end(), [](auto& a, auto& b) { return a.get_price() < b.get_price(); })->get_price());
+
+    for (double& p : prices) p *= 2;
+    CHECK(v[7].get_price() == prices[7]);
+
+    const auto& cv = v;
+    auto qty = unsafe::column_view<2>(cv);
+    static_assert(std::is_same_v<decltype(qty), unsafe::strided_view<const std::int32_t>>);
+    CHECK(std::accumulate(qty.begin(), qty.end(), std::int64_t(0)) ==
+          std::accumulate(v.begin(), v.end(), std::int64_t(0), [](auto s, auto& t) { return s + t.get_qty(); }));
+
+    CHECK(unsafe::column_view<1>(v.data(), 0).empty());
+}
+
+TEST_CASE("transpose")
+{
+    std::vector<trade> v = make_trades(1000);
+    auto [prices, qty, fees] = unsafe::transpose<1, 2, 5>(v);
+    static_assert(std::is_same_v<decltype(prices), std::vector<double>>);
+    static_assert(std::is_same_v<decltype(qty), std::vector<std::int32_t>>);
+    REQUIRE(prices.size() == v.size());
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        CHECK(prices[i] == v[i].get_price());
+        CHECK(qty[i] == v[i].get_qty());
+    }
+
+    auto columns = unsafe::transpose<1, 2>(v);
+    for (double& p : std::get<0>(columns)) p = -p;
+    for (auto& q : std::get<1>(columns)) q += 1;
+    unsafe::write_back<1, 2>(columns, v);
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        CHECK(v[i].get_price() == -prices[i]);
+        CHECK(v[i].get_qty() == qty[i] + 1);
+    }
+    CHECK(unsafe::get<0>(v[9]) == 9);
+}
+
+TEST_CASE("columns benchmark", "[.benchmark]")
+{
+    const std::size_t n = 1 << 20;
+    std::vector<trade> v = make_trades(n);
+    auto [prices, qty] = unsafe::transpose<1, 2>(v);
+    auto view = unsafe::column_view<1>(std::as_const(v));
+
+    BENCHMARK("transpose") { return unsafe::transpose<1, 2>(v); };
+
+    BENCHMARK("sum rows")
+    {
+        double s = 0;
+        for (const trade& t : v) s += t.get_price();
+        return s;
+    };
+    BENCHMARK("sum strided view") { return std::accumulate(view.begin(), view.end(), 0.0); };
+    BENCHMARK("sum column")
+    {
+        double s = 0;
+        for (double p : prices) s += p;
+        return s;
+    };
+
+    BENCHMARK("min/max rows")
+    {
+        std::int32_t lo = INT32_MAX, hi = INT32_MIN;
+        for (const trade& t : v) lo = std::min(lo, t.get_qty()), hi = std::max(hi, t.get_qty());
+        return hi - lo;
+    };
+    BENCHMARK("min/max column")
+    {
+        std::int32_t lo = INT32_MAX, hi = INT32_MIN;
+        for (std::int32_t q : qty) lo = std::min(lo, q), hi = std::max(hi, q);
+        return hi - lo;
+    };
+
+    BENCHMARK("filter rows")
+    {
+        std::size_t count = 0;
+        for (const trade& t : v) count += t.get_qty() > 5000;
+        return count;
+    };
+    BENCHMARK("filter column")
+    {
+        std::size_t count = 0;
+        for (std::int32_t q : qty) count += q > 5000;
+        return count;
+    };
+}
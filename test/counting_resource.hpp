@@ -0,0 +1,43 @@
+#ifndef UNSAFE_TEST_COUNTING_RESOURCE_HPP
+#define UNSAFE_TEST_COUNTING_RESOURCE_HPP
+
+#include <version>
+#ifdef __cpp_lib_memory_resource
+#include <memory_resource>
+#include <map>
+
+// Tracks every live allocation and checks it is deallocated with the same size.
+struct counting_resource : std::pmr::memory_resource
+{
+    std::map<void*, std::size_t> blocks;
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t mismatches = 0;
+
+    std::size_t outstanding() const noexcept { return blocks.size(); }
+
+    void* do_allocate(std::size_t n, std::size_t align) override
+    {
+        void* p = std::pmr::new_delete_resource()->allocate(n, align);
+        blocks[p] = n;
+        ++allocations;
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t n, std::size_t align) override
+    {
+        auto it = blocks.find(p);
+        if (it == blocks.end() || it->second != n) ++mismatches;
+        if (it != blocks.end()) blocks.erase(it);
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+#endif
+
+#endif
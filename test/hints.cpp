@@ -0,0 +1,109 @@
+#include "catch.hpp"
+
+#include <unsafe/hints.hpp>
+
+#include <sstream>
+
+#ifdef __linux__
+#include <sys/stat.h>
+
+namespace
+{
+    struct temp_file
+    {
+        const char* name;
+
+        temp_file(const char* name, std::size_t size) : name(name)
+        {
+            std::ofstream stream(name, std::ios_base::binary);
+            for (std::size_t i = 0; i < size; ++i) stream.put(char('a' + i % 26));
+        }
+
+        ~temp_file() { std::remove(name); }
+
+        struct stat status() const
+        {
+            struct stat st = {};
+            ::stat(name, &st);
+            return st;
+        }
+    };
+}
+
+TEST_CASE("file_position")
+{
+    temp_file file("unsafe.test.file_position", 100000);
+
+    {
+        std::ifstream stream(file.name, std::ios_base::binary);
+        char buf[10];
+        stream.read(buf, sizeof buf);
+
+        const int fd = unsafe::filebuf_fileno(stream.rdbuf());
+        CHECK(::lseek(fd, 0, SEEK_CUR) > 10); // The filebuf has read ahead.
+
+        auto [pfd, pos] = unsafe::file_position(stream, std::ios_base::in);
+        CHECK(pfd == fd);
+        CHECK(pos == 10);
+        CHECK(stream.get() == 'a' + 10);
+    }
+
+    {
+        std::ofstream stream(file.name, std::ios_base::binary | std::ios_base::app);
+        stream << "xyz";
+        auto [fd, pos] = unsafe::file_position(stream, std::ios_base::out);
+        CHECK(fd >= 0);
+        CHECK(pos == 100003);
+        CHECK(file.status().st_size == 100003); // Pending output is flushed.
+    }
+
+    std::stringstream ss("abc");
+    CHECK(unsafe::file_position(ss, std::ios_base::in).first == -1);
+    CHECK(unsafe::advise(ss, unsafe::access_advice::random) == EBADF);
+}
+
+TEST_CASE("advise")
+{
+    temp_file file("unsafe.test.advise", 1 << 20);
+    std::ifstream stream(file.name, std::ios_base::binary);
+
+    CHECK(unsafe::advise(stream, unsafe::access_advice::sequential) == 0);
+    CHECK(unsafe::advise(stream, unsafe::access_advice::random, 4096) == 0);
+    CHECK(unsafe::advise(stream, unsafe::access_advice::willneed) == 0);
+    CHECK(unsafe::advise(stream, unsafe::access_advice::noreuse) == 0);
+    CHECK(unsafe::advise(stream, unsafe::access_advice::dontneed) == 0);
+    CHECK(unsafe::advise(stream, unsafe::access_advice::normal) == 0);
+    CHECK(unsafe::readahead(stream, 1 << 20) == 0);
+
+    // Hints do not move the stream.
+    stream.seekg(12345);
+    CHECK(unsafe::advise(stream, unsafe::access_advice::willneed, 100) == 0);
+    CHECK(stream.tellg() == std::streampos(12345));
+    CHECK(stream.get() == 'a' + 12345 % 26);
+}
+
+TEST_CASE("preallocate")
+{
+    temp_file file("unsafe.test.preallocate", 0);
+
+    {
+        std::ofstream stream(file.name, std::ios_base::binary);
+        stream << "head";
+
+        const int r = unsafe::preallocate(stream, 16 << 20);
+        if (r == EOPNOTSUPP) return; // e.g. on tmpfs before Linux 3.5 or on some overlays.
+        REQUIRE(r == 0);
+
+        CHECK(file.status().st_size == 4);
+        CHECK(file.status().st_blocks * 512 >= (16 << 20));
+
+        stream << std::string(1000, 'x');
+        CHECK(unsafe::writeback(stream) == 0);
+        CHECK(unsafe::writeback(stream, 10,
+            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER) == 0);
+    }
+
+    // The reserved space past the written data does not show up as content.
+    CHECK(file.status().st_size == 1004);
+}
+#endif
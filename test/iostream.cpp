@@ -113,3 +113,446 @@ TEST_CASE("fstream")
 
     std::remove(filename);
 }
+
+#include <sstream>
+#include <string_view>
+
+namespace
+{
+    // Calls f with each line of the stream, viewed in place in the get area when it is
+    // not split by a refill.
+    template<class F>
+    void for_each_line(std::istream& stream, F f)
+    {
+        std::streambuf* buf = stream.rdbuf();
+        std::string carry;
+        while (unsafe::underflow(buf))
+        {
+            auto [eback, gptr, egptr] = unsafe::get_area(buf);
+            (void)eback;
+            const char* p = gptr;
+            while (const char* q = static_cast<const char*>(std::memchr(p, '\n', egptr - p)))
+            {
+                if (carry.empty()) f(std::string_view(p, q - p));
+                else f(std::string_view(carry.append(p, q - p))), carry.clear();
+                p = q + 1;
+            }
+            carry.append(p, egptr - p);
+            unsafe::advance_get(buf, egptr - gptr);
+        }
+        if (!carry.empty()) f(std::string_view(carry));
+    }
+
+    void write_lines(const char* filename, std::size_t n)
+    {
+        std::ofstream stream(filename, std::ios_base::binary);
+        for (std::size_t i = 0; i < n; ++i)
+            stream << "line " << i << " " << std::string(i % 97, 'x') << '\n';
+    }
+}
+
+TEST_CASE("streambuf get area")
+{
+    std::istringstream stream("ab\ncd\n\nefg");
+    auto [eback, gptr, egptr] = unsafe::get_area(stream.rdbuf());
+    CHECK(std::string_view(gptr, egptr - gptr) == "ab\ncd\n\nefg");
+    CHECK(eback == gptr);
+
+    unsafe::advance_get(stream.rdbuf(), 3);
+    std::string line;
+    CHECK(std::getline(stream, line));
+    CHECK(line == "cd");
+
+    stream.seekg(0);
+    std::vector<std::string> lines;
+    for_each_line(stream, [&](std::string_view s) { lines.emplace_back(s); });
+    CHECK(lines == std::vector<std::string>{"ab", "cd", "", "efg"});
+}
+
+TEST_CASE("filebuf get area")
+{
+    const char* filename = "unsafe.test.filebuf.get";
+    write_lines(filename, 10000);
+
+    std::vector<std::string> expected;
+    {
+        std::ifstream stream(filename, std::ios_base::binary);
+        for (std::string line; std::getline(stream, line);) expected.push_back(line);
+    }
+
+    {
+        std::ifstream stream(filename, std::ios_base::binary);
+        auto [eback, gptr, egptr] = unsafe::get_area(stream.rdbuf());
+        CHECK(gptr == egptr);
+
+        std::vector<std::string> lines;
+        for_each_line(stream, [&](std::string_view s) { lines.emplace_back(s); });
+        CHECK(lines == expected);
+        CHECK(unsafe::underflow(stream.rdbuf()) == 0);
+    }
+
+    std::remove(filename);
+}
+
+TEST_CASE("filebuf put area")
+{
+    const char* filename = "unsafe.test.filebuf.put";
+
+    {
+        std::ofstream stream(filename, std::ios_base::binary);
+        std::streambuf* buf = stream.rdbuf();
+        stream << "x";
+
+        std::size_t written = 0;
+        while (written < 100000)
+        {
+            const std::size_t n = unsafe::overflow(buf);
+            REQUIRE(n != 0);
+            auto [pbase, pptr, epptr] = unsafe::put_area(buf);
+            (void)pbase;
+            CHECK(std::size_t(epptr - pptr) == n);
+
+            const std::size_t m = std::min(n, 100000 - written);
+            std::memset(pptr, 'y', m);
+            unsafe::commit_put(buf, m);
+            written += m;
+        }
+        stream << "z";
+    }
+
+    {
+        std::ifstream stream(filename, std::ios_base::binary);
+        std::string s((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        CHECK(s == "x" + std::string(100000, 'y') + "z");
+    }
+
+    std::remove(filename);
+}
+
+TEST_CASE("filebuf get area benchmark", "[.benchmark]")
+{
+    const char* filename = "unsafe.test.filebuf.benchmark";
+    write_lines(filename, 1000000);
+
+    BENCHMARK("std::getline")
+    {
+        std::ifstream stream(filename, std::ios_base::binary);
+        std::size_t n = 0;
+        for (std::string line; std::getline(stream, line);) n += line.size();
+        return n;
+    };
+
+    BENCHMARK("unsafe::get_area")
+    {
+        std::ifstream stream(filename, std::ios_base::binary);
+        std::size_t n = 0;
+        for_each_line(stream, [&](std::string_view s) { n += s.size(); });
+        return n;
+    };
+
+    std::remove(filename);
+}
+
+#ifndef _MSVC_STL_UPDATE
+TEST_CASE("filebuf_setbuf")
+{
+    const char* filename = "unsafe.test.filebuf_setbuf";
+    std::vector<char> buffer(1 << 20);
+
+    {
+        std::ofstream stream(filename, std::ios_base::binary);
+        stream << "head ";
+        REQUIRE(unsafe::filebuf_setbuf(stream.rdbuf(), buffer.data(), buffer.size()));
+        auto [p, n] = unsafe::filebuf_buffer(stream.rdbuf());
+        CHECK(p == buffer.data());
+        CHECK(n == buffer.size());
+        for (int i = 0; i < 100000; ++i) stream << i << ' ';
+    }
+
+    std::string expected = "head ";
+    for (int i = 0; i < 100000; ++i) expected += std::to_string(i) + ' ';
+
+    {
+        std::ifstream stream(filename, std::ios_base::binary);
+        std::string head;
+        CHECK(stream >> head);
+        CHECK(head == "head");
+
+        // The read-ahead of the old buffer is given back.
+        std::vector<char> small(100);
+        REQUIRE(unsafe::filebuf_setbuf(stream.rdbuf(), small.data(), small.size()));
+        std::string s((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        CHECK(s == expected.substr(4));
+    }
+
+    std::remove(filename);
+}
+
+TEST_CASE("filebuf_setbuf benchmark", "[.benchmark]")
+{
+    const char* filename = "unsafe.test.filebuf_setbuf.benchmark";
+    const std::size_t size = GENERATE(std::size_t(0), std::size_t(64) << 10, std::size_t(1) << 20, std::size_t(16) << 20);
+    CAPTURE(size);
+
+    std::vector<char> buffer(size);
+    const std::string record(40, 'r');
+
+    BENCHMARK("write 256 MiB in 40-byte records")
+    {
+        std::ofstream stream(filename, std::ios_base::binary);
+        if (size) unsafe::filebuf_setbuf(stream.rdbuf(), buffer.data(), buffer.size());
+        for (std::size_t n = 0; n < (std::size_t(256) << 20); n += record.size() + 1)
+            stream << record << '\n';
+        return stream.tellp();
+    };
+
+    std::remove(filename);
+}
+#endif
+
+TEST_CASE("stream_copy")
+{
+    const char* src = "unsafe.test.stream_copy.src";
+    const char* dst = "unsafe.test.stream_copy.dst";
+
+    std::string content;
+    for (int i = 0; i < 200000; ++i) content += std::to_string(i) + '\n';
+    std::ofstream(src, std::ios_base::binary) << content;
+
+    const auto read_file = [](const char* filename) {
+        std::ifstream stream(filename, std::ios_base::binary);
+        return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    };
+
+    SECTION("whole file")
+    {
+        {
+            std::ifstream is(src, std::ios_base::binary);
+            std::ofstream os(dst, std::ios_base::binary);
+            CHECK(unsafe::stream_copy(is, os) == std::streamsize(content.size()));
+            CHECK(is.eof());
+            CHECK(os.good());
+            CHECK(os.tellp() == std::streampos(content.size()));
+        }
+        CHECK(read_file(dst) == content);
+    }
+
+    SECTION("positions stay in sync")
+    {
+        {
+            std::ifstream is(src, std::ios_base::binary);
+            std::ofstream os(dst, std::ios_base::binary);
+
+            std::string line;
+            std::getline(is, line);
+            os << "[" << line << "]";
+
+            CHECK(unsafe::stream_copy(is, os, 100000) == 100000);
+            CHECK(is.tellg() == std::streampos(line.size() + 1 + 100000));
+            CHECK(os.tellp() == std::streampos(line.size() + 2 + 100000));
+
+            os << "|" << is.rdbuf();
+        }
+        CHECK(read_file(dst) == "[0]" + content.substr(2, 100000) + "|" + content.substr(100002));
+    }
+
+    SECTION("after extractions")
+    {
+        // Past a few buffers, so that a FILE under the filebuf has read ahead.
+        std::string head;
+        {
+            std::ifstream is(src, std::ios_base::binary);
+            std::ofstream os(dst, std::ios_base::binary);
+
+            for (std::string line; head.size() < 3 * BUFSIZ && std::getline(is, line);)
+                head += line + '\n';
+
+            CHECK(unsafe::stream_copy(is, os) == std::streamsize(content.size() - head.size()));
+            CHECK(os.tellp() == std::streampos(content.size() - head.size()));
+            is.clear();
+            CHECK(is.tellg() == std::streampos(content.size()));
+        }
+        CHECK(head + read_file(dst) == content);
+    }
+
+    SECTION("buffered fallback")
+    {
+        std::istringstream is(content);
+        std::ostringstream os;
+        CHECK(unsafe::stream_copy(is, os, 12345) == 12345);
+        CHECK(unsafe::stream_copy(is, os) == std::streamsize(content.size() - 12345));
+        CHECK(is.eof());
+        CHECK(os.str() == content);
+    }
+
+    std::remove(src);
+    std::remove(dst);
+}
+
+TEST_CASE("stream_copy benchmark", "[.benchmark]")
+{
+    const char* src = "unsafe.test.stream_copy.benchmark.src";
+    const char* dst = "unsafe.test.stream_copy.benchmark.dst";
+    {
+        std::ofstream stream(src, std::ios_base::binary);
+        const std::string block(1 << 20, 'b');
+        for (int i = 0; i < 256; ++i) stream << block;
+    }
+
+    BENCHMARK("os << is.rdbuf()")
+    {
+        std::ifstream is(src, std::ios_base::binary);
+        std::ofstream os(dst, std::ios_base::binary);
+        os << is.rdbuf();
+        return os.tellp();
+    };
+
+    BENCHMARK("unsafe::stream_copy")
+    {
+        std::ifstream is(src, std::ios_base::binary);
+        std::ofstream os(dst, std::ios_base::binary);
+        unsafe::stream_copy(is, os);
+        return os.tellp();
+    };
+
+    std::remove(src);
+    std::remove(dst);
+}
+
+#ifdef __GLIBCXX__
+#include <thread>
+
+TEST_CASE("stdio_lock")
+{
+    FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    {
+        __gnu_cxx::stdio_sync_filebuf<char> sb(file);
+        std::ostream os(&sb);
+        os << "a";
+        {
+            unsafe::stdio_lock lock(os);
+            CHECK(lock.locked());
+            CHECK(os.rdbuf() != &sb);
+            os << "b" << 42 << std::string(1000, 'c');
+            std::fputs("d", file); // Same thread, the lock is recursive.
+            os.put('e').write("fg", 2);
+            CHECK(os.flush());
+        }
+        CHECK(os.rdbuf() == &sb);
+        os << "h" << std::flush;
+    }
+
+    std::rewind(file);
+    {
+        __gnu_cxx::stdio_sync_filebuf<char> sb(file);
+        std::istream is(&sb);
+        char c = 0;
+        CHECK(is.get(c));
+        CHECK(c == 'a');
+        {
+            unsafe::stdio_lock lock(is);
+            int n = 0;
+            CHECK(is >> c >> n);
+            CHECK((c == 'b' && n == 42));
+            std::string s(1000, 0);
+            CHECK(is.read(&s[0], 1000));
+            CHECK(s == std::string(1000, 'c'));
+            CHECK(is.peek() == 'd'); // Read ahead, put back when the scope ends.
+        }
+        CHECK(std::fgetc(file) == 'd');
+        std::string rest;
+        CHECK(is >> rest);
+        CHECK(rest == "efgh");
+    }
+
+    std::fclose(file);
+
+    std::ofstream fs;
+    unsafe::stdio_lock lock(fs);
+    CHECK(!lock.locked());
+}
+
+TEST_CASE("stdio_lock benchmark", "[.benchmark]")
+{
+    FILE* file = std::fopen("/dev/null", "w");
+    REQUIRE(file != nullptr);
+    __gnu_cxx::stdio_sync_filebuf<char> sb(file);
+    std::ostream os(&sb);
+
+    // glibc skips FILE locking until the process starts a second thread.
+    std::thread([] {}).join();
+
+    const auto lines = [&os] {
+        for (int i = 0; i < 100000; ++i) os << "line " << i << ' ' << 'x' << '\n';
+        return os.good();
+    };
+
+    BENCHMARK("stdio synced") { return lines(); };
+    BENCHMARK("unsafe::stdio_lock")
+    {
+        unsafe::stdio_lock lock(os);
+        return lines();
+    };
+
+    std::fclose(file);
+}
+#endif
+
+TEST_CASE("stream_handle")
+{
+    CHECK(unsafe::classify_streambuf(std::cout.rdbuf()) == unsafe::streambuf_kind::stdio);
+    CHECK(unsafe::classify_streambuf(std::cout.rdbuf()) == unsafe::streambuf_kind::stdio);
+
+    std::stringbuf sb;
+    CHECK(unsafe::classify_streambuf(&sb) == unsafe::streambuf_kind::other);
+    CHECK(unsafe::streambuf_FILE(&sb) == nullptr);
+    CHECK(unsafe::streambuf_fileno(&sb) == -1);
+
+    struct derived : std::filebuf {};
+    derived db;
+    CHECK(unsafe::classify_streambuf(&db) == unsafe::streambuf_kind::filebuf);
+    CHECK(unsafe::classify_streambuf(&db) == unsafe::streambuf_kind::filebuf);
+
+    unsafe::stream_handle out(std::cout);
+    CHECK(out.file() == stdout);
+    CHECK(out.fileno() == 1);
+    CHECK(out.native_handle() == unsafe::streambuf_native_handle(std::cout.rdbuf()));
+
+    unsafe::wstream_handle werr(std::wcerr);
+    CHECK(werr.file() == stderr);
+    CHECK(werr.fileno() == 2);
+
+    const char* filename = "unsafe.test.stream_handle";
+    {
+        std::ofstream stream(filename);
+        unsafe::stream_handle h(stream);
+        CHECK(h.file() == unsafe::filebuf_FILE(stream.rdbuf()));
+        CHECK(h.fileno() == unsafe::filebuf_fileno(stream.rdbuf()));
+        CHECK(h.fileno() >= 0);
+    }
+    std::remove(filename);
+
+    unsafe::stream_handle none(&sb);
+    CHECK(none.file() == nullptr);
+    CHECK(none.fileno() == -1);
+}
+
+TEST_CASE("stream_handle benchmark", "[.benchmark]")
+{
+    std::streambuf* buf = std::cout.rdbuf();
+
+    BENCHMARK("dynamic_cast lookup")
+    {
+        if (auto f = dynamic_cast<std::filebuf*>(buf)) return unsafe::filebuf_fileno(f);
+#ifdef __GLIBCXX__
+        if (auto f = dynamic_cast<__gnu_cxx::stdio_sync_filebuf<char>*>(buf)) return fileno(f->file());
+#endif
+        return -1;
+    };
+    BENCHMARK("unsafe::streambuf_fileno") { return unsafe::streambuf_fileno(buf); };
+
+    unsafe::stream_handle h(std::cout);
+    BENCHMARK("unsafe::stream_handle::fileno") { return h.fileno(); };
+}
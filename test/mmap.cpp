@@ -0,0 +1,95 @@
+#include "catch.hpp"
+
+#if !defined(_WIN32) && !defined(_LIBCPP_VERSION)
+#include <unsafe/mmap.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+namespace
+{
+    void write_file(const char* filename, const void* data, std::size_t size)
+    {
+        std::ofstream stream(filename, std::ios_base::binary);
+        stream.write(static_cast<const char*>(data), size);
+    }
+}
+
+TEST_CASE("mapped_vector")
+{
+    const char* filename = "unsafe.test.mapped_vector";
+
+    std::vector<int> expected(10000);
+    std::iota(expected.begin(), expected.end(), 0);
+    write_file(filename, expected.data(), expected.size() * sizeof(int));
+
+    {
+        unsafe::mapped_vector<int> mv(filename);
+        static_assert(std::is_same_v<decltype(mv.get()), const std::vector<int>&>);
+        const std::vector<int>& v = mv;
+        CHECK(v == expected);
+        CHECK(mv.advise(unsafe::map_advice::sequential) == 0);
+        CHECK(mv.advise(unsafe::map_advice::willneed) == 0);
+    }
+
+    {
+        unsafe::mapped_vector<int, unsafe::map_mode::copy_on_write> mv(filename);
+        std::vector<int>& v = mv;
+        v[0] = -1;
+        CHECK(v[0] == -1);
+        CHECK(mv.advise(unsafe::map_advice::random) == 0);
+    }
+
+    {
+        unsafe::mapped_vector<int> mv(filename);
+        CHECK(mv.get().front() == 0);
+    }
+
+    write_file(filename, nullptr, 0);
+    {
+        unsafe::mapped_vector<int> mv(filename);
+        CHECK(mv.get().empty());
+    }
+
+    std::remove(filename);
+    CHECK_THROWS_AS(unsafe::mapped_vector<int>(filename), std::system_error);
+}
+
+TEST_CASE("mapped_string")
+{
+    const char* filename = "unsafe.test.mapped_string";
+
+    // A multiple of the page size leaves no room for a terminator inside the file mapping.
+    const std::size_t size = GENERATE(0, 100, 4096, 65536);
+    CAPTURE(size);
+
+    std::string expected(size, 'x');
+    for (std::size_t i = 0; i < size; i += 7) expected[i] = 'y';
+    write_file(filename, expected.data(), expected.size());
+
+    {
+        unsafe::mapped_string<char> ms(filename);
+        static_assert(std::is_same_v<decltype(ms.get()), const std::string&>);
+        const std::string& s = ms;
+        CHECK(s == expected);
+        CHECK(s.c_str()[size] == '\0');
+        CHECK(s.find('z') == std::string::npos);
+    }
+
+    {
+        unsafe::mapped_string<char, unsafe::map_mode::copy_on_write> ms(filename);
+        std::string& s = ms;
+        if (size) s[0] = 'z';
+        CHECK(s.size() == size);
+    }
+
+    {
+        unsafe::mapped_string<char> ms(filename);
+        CHECK(ms.get() == expected);
+    }
+
+    std::remove(filename);
+}
+
+#endif
@@ -2,6 +2,29 @@
 
 #include <unsafe/pointer.hpp>
 
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct counted
+    {
+        static inline std::atomic<int> alive{0};
+        int a, b;
+        counted(int v) : a(v), b(v) { ++alive; }
+        ~counted() { --alive; }
+    };
+
+    // Runs f(i) on n threads and returns when all are done.
+    template<class F>
+    void run_threads(int n, F f)
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < n; ++i) threads.emplace_back(f, i);
+        for (auto& t : threads) t.join();
+    }
+}
+
 TEST_CASE("shared_ptr")
 {
     struct A : std::enable_shared_from_this<A> {};
@@ -23,3 +46,229 @@ TEST_CASE("shared_ptr")
     CHECK_THROWS_AS(unsafe::shared_from_this(&b), std::bad_weak_ptr);
     CHECK_THROWS_AS(unsafe::release_from_this(sp), std::bad_weak_ptr);
 }
+
+TEST_CASE("shared_from_this round trip benchmark", "[.benchmark]")
+{
+    std::thread([] {}).join(); // libstdc++ skips atomics while single-threaded.
+
+    struct A : std::enable_shared_from_this<A> { int v = 1; };
+    constexpr int trips = 100000;
+    auto sp = std::make_shared<A>();
+
+    // Handing sp through a void* context and back. shared_from_this() costs an
+    // increment and assigning it to sp a decrement; the unsafe functions move the
+    // ownership of sp through the raw pointer without touching the counts.
+    BENCHMARK("std::enable_shared_from_this")
+    {
+        long sum = 0;
+        for (int i = 0; i < trips; ++i)
+        {
+            void* ctx = sp.get();
+            sp = static_cast<A*>(ctx)->shared_from_this();
+            sum += sp->v;
+        }
+        return sum;
+    };
+
+    BENCHMARK("unsafe::release_from_this/shared_from_this")
+    {
+        long sum = 0;
+        for (int i = 0; i < trips; ++i)
+        {
+            void* ctx = unsafe::release_from_this(std::move(sp));
+            sp = unsafe::shared_from_this(static_cast<A*>(ctx));
+            sum += sp->v;
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("control_block")
+{
+    auto sp = std::make_shared<int>(1);
+    std::weak_ptr<int> wp = sp;
+    unsafe::control_block* cb = unsafe::get_control_block(sp);
+    CHECK(cb->use_count() == 1);
+    CHECK(cb->weak_count() == 1);
+
+    cb->retain(3);
+    CHECK(sp.use_count() == 4);
+    cb->release(3);
+    CHECK(sp.use_count() == 1);
+
+    // Batches while other threads copy and drop the same object.
+    run_threads(4, [&](int i) {
+        for (int k = 0; k < 10000; ++k)
+        {
+            if (i % 2) { cb->retain(2); cb->release(2); }
+            else { auto copy = sp; }
+        }
+    });
+    CHECK(cb->use_count() == 1);
+
+    sp.reset();
+    CHECK(wp.expired());
+    CHECK(cb->weak_count() == 1);
+}
+
+TEST_CASE("local_shared_ptr")
+{
+    unsafe::local_shared_ptr<counted> a(std::make_shared<counted>(7));
+    {
+        auto b = a;
+        unsafe::local_shared_ptr<counted> c;
+        c = b;
+        CHECK(a.use_count() == 3);
+        CHECK(c->a == 7);
+        CHECK(c.get() == a.get());
+
+        std::shared_ptr<counted> s = c.shared();
+        CHECK(a.use_count() == 4);
+        CHECK(a.local_use_count() == 3);
+    }
+    CHECK(a.use_count() == 1);
+    CHECK(counted::alive == 1);
+
+    // Owners on other threads come from shared() and are counted apart from local ones.
+    std::shared_ptr<counted> s = a.shared();
+    std::thread t([s = std::move(s)]() mutable {
+        for (int k = 0; k < 10000; ++k) auto copy = s;
+        s.reset();
+    });
+    for (int k = 0; k < 10000; ++k) auto copy = a;
+    t.join();
+    CHECK(a.use_count() == 1);
+
+    a.reset();
+    CHECK_FALSE(a);
+    CHECK(counted::alive == 0);
+}
+
+TEST_CASE("local_shared_ptr benchmark", "[.benchmark]")
+{
+    std::thread([] {}).join(); // libstdc++ skips atomics while single-threaded.
+
+    constexpr int copies = 100000;
+    auto sp = std::make_shared<int>(1);
+    unsafe::local_shared_ptr<int> lp(sp);
+
+    BENCHMARK("std::shared_ptr copies")
+    {
+        std::vector<std::shared_ptr<int>> v(copies, sp);
+        return v.size();
+    };
+
+    BENCHMARK("unsafe::local_shared_ptr copies")
+    {
+        std::vector<unsafe::local_shared_ptr<int>> v(copies, lp);
+        return v.size();
+    };
+}
+
+TEST_CASE("atomic_shared_ptr")
+{
+    unsafe::atomic_shared_ptr<int> a;
+    CHECK(a.is_lock_free());
+    CHECK(a.load() == nullptr);
+
+    // Loads of an empty value leave their counts behind, past the reader limit.
+    bool empty = true;
+    for (int i = 0; i < 100000; ++i) empty = empty && a.load() == nullptr;
+    CHECK(empty);
+
+    auto p = std::make_shared<int>(1);
+    a.store(p);
+    CHECK(a.load() == p);
+    CHECK(p.use_count() == 2);
+
+    auto q = std::make_shared<int>(2);
+    CHECK(a.exchange(q) == p);
+    CHECK(p.use_count() == 1);
+
+    std::shared_ptr<int> e = p;
+    CHECK_FALSE(a.compare_exchange_strong(e, nullptr));
+    CHECK(e == q);
+    CHECK(a.compare_exchange_strong(e, p));
+    CHECK(a.load() == p);
+
+    // Same stored pointer but different ownership is not equivalent.
+    e = std::shared_ptr<int>(q, p.get());
+    CHECK_FALSE(a.compare_exchange_strong(e, q));
+    CHECK(unsafe::equivalent(e, p));
+
+    a.store(nullptr);
+    e = nullptr;
+    CHECK(a.compare_exchange_strong(e, q));
+    CHECK(q.use_count() == 2);
+}
+
+TEST_CASE("atomic_shared_ptr stress")
+{
+    constexpr int threads = 8;
+    constexpr int iterations = 20000;
+    {
+        unsafe::atomic_shared_ptr<counted> a(std::make_shared<counted>(0));
+        std::atomic<int> torn{0}, swapped{0};
+
+        run_threads(threads, [&](int t) {
+            for (int i = 0; i < iterations; ++i)
+            {
+                switch ((t + i) % 4)
+                {
+                case 0:
+                    a.store(std::make_shared<counted>(i));
+                    break;
+                case 1:
+                    a.exchange(std::make_shared<counted>(-i));
+                    break;
+                case 2:
+                {
+                    auto e = a.load();
+                    swapped += a.compare_exchange_strong(e, std::make_shared<counted>(t));
+                    break;
+                }
+                default:
+                    for (int k = 0; k < 4; ++k)
+                        if (auto p = a.load(); p->a != p->b) ++torn;
+                }
+            }
+        });
+
+        CHECK(torn == 0);
+        CHECK(swapped > 0);
+        CHECK(counted::alive == 1);
+    }
+    CHECK(counted::alive == 0);
+}
+
+TEST_CASE("atomic_shared_ptr benchmark", "[.benchmark]")
+{
+    const int threads = GENERATE(1, 2, 4, 8);
+    constexpr int loads = 100000;
+    CAPTURE(threads);
+
+    auto sp = std::make_shared<int>(1);
+    unsafe::atomic_shared_ptr<int> a(sp);
+
+    BENCHMARK("std::atomic_load")
+    {
+        std::atomic<long> sum{0};
+        run_threads(threads, [&](int) {
+            long s = 0;
+            for (int i = 0; i < loads; ++i) s += *std::atomic_load(&sp);
+            sum += s;
+        });
+        return sum.load();
+    };
+
+    BENCHMARK("unsafe::atomic_shared_ptr::load")
+    {
+        std::atomic<long> sum{0};
+        run_threads(threads, [&](int) {
+            long s = 0;
+            for (int i = 0; i < loads; ++i) s += *a.load();
+            sum += s;
+        });
+        return sum.load();
+    };
+}
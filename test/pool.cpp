@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <unsafe/pool.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct order
+    {
+        static inline std::atomic<int> alive{0};
+        long id;
+        double price;
+        order(long id, double price) : id(id), price(price) { ++alive; }
+        ~order() { --alive; }
+    };
+}
+
+TEST_CASE("make_pooled")
+{
+    auto a = unsafe::make_pooled<order>(1, 2.5);
+    CHECK(a->id == 1);
+    CHECK(a->price == 2.5);
+    CHECK(a.use_count() == 1);
+
+    std::weak_ptr<order> w = a;
+    const void* block = a.get();
+    a.reset();
+    CHECK(w.expired());
+    CHECK(order::alive == 0);
+    w.reset();
+
+    // The block is reused once the weak_ptr is gone too.
+    a = unsafe::make_pooled<order>(2, 0.0);
+    CHECK(a.get() == block);
+
+    std::vector<std::shared_ptr<order>> v;
+    for (int i = 0; i < 10000; ++i) v.push_back(unsafe::make_pooled<order>(i, i));
+    for (int i = 0; i < 10000; ++i) CHECK(v[i]->id == i);
+    v.clear();
+    a.reset();
+    CHECK(order::alive == 0);
+
+    struct alignas(64) wide { char c[100]; };
+    auto b = unsafe::make_pooled<wide>();
+    CHECK(reinterpret_cast<std::uintptr_t>(b.get()) % 64 == 0);
+}
+
+TEST_CASE("make_pooled cross-thread")
+{
+    constexpr int n = 20000;
+    std::vector<std::shared_ptr<order>> made(n), more(n);
+    for (int i = 0; i < n; ++i) made[i] = unsafe::make_pooled<order>(i, 0.0);
+
+    // Released on other threads while this one keeps allocating from the same pool.
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < 4; ++t)
+        consumers.emplace_back([&, t] {
+            for (int i = t; i < n; i += 4) made[i].reset();
+        });
+    for (int i = 0; i < n; ++i) more[i] = unsafe::make_pooled<order>(i, 0.0);
+    for (auto& c : consumers) c.join();
+    CHECK(order::alive == n);
+    for (int i = 0; i < n; ++i) CHECK(more[i]->id == i);
+    more.clear();
+    CHECK(order::alive == 0);
+
+    // Blocks outliving their thread stay valid.
+    std::shared_ptr<order> survivor;
+    std::thread([&] { survivor = unsafe::make_pooled<order>(42, 0.0); }).join();
+    CHECK(survivor->id == 42);
+    survivor.reset();
+    CHECK(order::alive == 0);
+}
+
+TEST_CASE("make_pooled benchmark", "[.benchmark]")
+{
+    std::thread([] {}).join();
+
+    constexpr int live = 1000;
+    constexpr int rounds = 100;
+    std::vector<std::shared_ptr<order>> book(live);
+
+    BENCHMARK("std::make_shared churn")
+    {
+        for (int r = 0; r < rounds; ++r)
+            for (int i = 0; i < live; ++i) book[i] = std::make_shared<order>(i, r);
+        return book.size();
+    };
+
+    BENCHMARK("unsafe::make_pooled churn")
+    {
+        for (int r = 0; r < rounds; ++r)
+            for (int i = 0; i < live; ++i) book[i] = unsafe::make_pooled<order>(i, r);
+        return book.size();
+    };
+}
@@ -0,0 +1,146 @@
+#include "catch.hpp"
+
+#include <unsafe/read.hpp>
+
+#include <sstream>
+
+namespace
+{
+    std::string make_content(std::size_t size)
+    {
+        std::string s(size, 0);
+        for (std::size_t i = 0; i < size; ++i) s[i] = char('a' + i * 7 % 26);
+        return s;
+    }
+
+    void write_file(const char* filename, const std::string& content)
+    {
+        std::ofstream(filename, std::ios_base::binary) << content;
+    }
+}
+
+TEST_CASE("read_all")
+{
+    const char* filename = "unsafe.test.read_all";
+    const std::size_t size = GENERATE(0, 1, 1000, 65536, 1000000);
+    CAPTURE(size);
+
+    const std::string content = make_content(size);
+    write_file(filename, content);
+
+    SECTION("string")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        std::string s = "prefix";
+        CHECK(unsafe::read_all(is, s) == size);
+        CHECK(s == "prefix" + content);
+        CHECK(is.eof());
+        CHECK(!is.fail());
+    }
+
+    SECTION("vector after buffered reads")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        std::string head(std::min<std::size_t>(size, 10), 0);
+        is.read(&head[0], head.size());
+
+        std::vector<char> v;
+        CHECK(unsafe::read_all(is, v) == size - head.size());
+        CHECK(head + std::string(v.begin(), v.end()) == content);
+        // Sized once from fstat, even for an empty file.
+        CHECK(v.capacity() == v.size());
+    }
+
+    SECTION("string after extractions")
+    {
+        // Past a few buffers, so that a FILE under the filebuf has read ahead.
+        std::ifstream is(filename, std::ios_base::binary);
+        const std::size_t n = std::min<std::size_t>(size, 3 * BUFSIZ + 7);
+        std::string head;
+        for (char ch; head.size() < n && is >> ch;)
+        {
+            head += ch;
+            if (head.size() < n) head += char(is.get());
+        }
+
+        std::string s;
+        CHECK(unsafe::read_all(is, s) == size - head.size());
+        CHECK(head + s == content);
+
+        // The stream carries on where read_all stopped.
+        is.clear();
+        CHECK(is.tellg() == std::streamoff(size));
+    }
+
+    SECTION("read_n")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        std::vector<char> v;
+        const std::size_t n = size / 2;
+        CHECK(unsafe::read_n(is, v, n) == n);
+        CHECK(std::string(v.begin(), v.end()) == content.substr(0, n));
+        CHECK(is.good());
+
+        // The stream carries on where read_n stopped.
+        std::string rest((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+        CHECK(rest == content.substr(n));
+
+        is.clear();
+        v.clear();
+        CHECK(unsafe::read_n(is, v, 1) == 0);
+        CHECK(is.fail());
+    }
+
+    SECTION("without file descriptor")
+    {
+        std::istringstream is(content);
+        std::string s;
+        CHECK(unsafe::read_n(is, s, size / 3) == size / 3);
+        CHECK(unsafe::read_all(is, s) == size - size / 3);
+        CHECK(s == content);
+    }
+
+    std::remove(filename);
+}
+
+TEST_CASE("read_all benchmark", "[.benchmark]")
+{
+    const char* filename = "unsafe.test.read_all.benchmark";
+    const std::size_t size = GENERATE(std::size_t(1) << 10, std::size_t(1) << 20, std::size_t(256) << 20);
+    CAPTURE(size);
+    write_file(filename, make_content(size));
+
+    BENCHMARK("istreambuf_iterator")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()).size();
+    };
+
+    BENCHMARK("ostringstream << rdbuf()")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        std::ostringstream os;
+        os << is.rdbuf();
+        return os.str().size();
+    };
+
+    BENCHMARK("seekg/tellg + read")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        is.seekg(0, std::ios_base::end);
+        std::string s(static_cast<std::size_t>(is.tellg()), 0);
+        is.seekg(0);
+        is.read(&s[0], s.size());
+        return s.size();
+    };
+
+    BENCHMARK("unsafe::read_all")
+    {
+        std::ifstream is(filename, std::ios_base::binary);
+        std::string s;
+        unsafe::read_all(is, s);
+        return s.size();
+    };
+
+    std::remove(filename);
+}
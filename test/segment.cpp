@@ -0,0 +1,111 @@
+#include "catch.hpp"
+
+#if !defined(_WIN32) && !defined(_LIBCPP_VERSION)
+#include <unsafe/segment.hpp>
+
+#include <numeric>
+
+#include <fcntl.h> // O_*
+#include <sys/mman.h> // shm_open, mmap
+#include <sys/wait.h> // waitpid
+#include <unistd.h> // fork, ftruncate
+
+namespace
+{
+    struct root
+    {
+        unsafe::segment_vector<int> ints;
+        unsafe::segment_string<char> name;
+        unsafe::segment_vector<double> empty;
+    };
+
+    void* map_shm(const char* name, std::size_t size)
+    {
+        const int fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0) return nullptr;
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    bool check_segment(const void* base, const std::vector<int>& ints, const std::string& name)
+    {
+        const root& r = *static_cast<const root*>(base);
+        auto bv = unsafe::rehydrate(base, r.ints);
+        auto bs = unsafe::rehydrate(base, r.name);
+        auto be = unsafe::rehydrate(base, r.empty);
+        static_assert(std::is_same_v<decltype(bv.get()), const std::vector<int>&>);
+        static_assert(std::is_same_v<decltype(bs.get()), const std::string&>);
+        const std::vector<int>& v = bv;
+        const std::string& s = bs;
+        return v == ints && s == name && s.c_str()[s.size()] == '\0' && be.get().empty() &&
+            v.data() == unsafe::segment_at<int>(base, r.ints.offset);
+    }
+}
+
+TEST_CASE("segment")
+{
+    const char* name = "/unsafe.test.segment";
+    const std::size_t size = 1 << 20;
+
+    std::vector<int> ints(10000);
+    std::iota(ints.begin(), ints.end(), 0);
+    const std::string str(1000, 's');
+
+    shm_unlink(name);
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    REQUIRE(fd >= 0);
+    REQUIRE(ftruncate(fd, size) == 0);
+    close(fd);
+
+    void* base = map_shm(name, size);
+    REQUIRE(base != nullptr);
+
+    unsafe::segment_writer w(base, size);
+    root* r = w.construct<root>();
+    CHECK(static_cast<void*>(r) == base);
+    r->ints = w.store(ints);
+    r->name = w.store(str);
+    r->empty = w.store(std::vector<double>());
+    CHECK(w.size() <= size);
+    CHECK_THROWS_AS(w.allocate(size, 1), std::bad_alloc);
+
+    CHECK(check_segment(base, ints, str));
+
+    // Each child maps the segment again at another address while the inherited
+    // mapping is still in place, and sees the same containers.
+    for (int i = 0; i < 4; ++i)
+    {
+        const pid_t pid = fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0)
+        {
+            void* p = map_shm(name, size);
+            _exit(p != nullptr && p != base && check_segment(p, ints, str) ? 0 : 1);
+        }
+
+        int status = 0;
+        CHECK(waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+    }
+
+    // A modification through a view in one process is visible in the others.
+    {
+        auto bv = unsafe::rehydrate(base, r->ints);
+        std::vector<int>& v = bv;
+        v[0] = -1;
+    }
+    ints[0] = -1;
+
+    void* other = map_shm(name, size);
+    REQUIRE(other != nullptr);
+    CHECK(other != base);
+    CHECK(check_segment(other, ints, str));
+
+    munmap(other, size);
+    munmap(base, size);
+    shm_unlink(name);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include "catch.hpp"
+
+#include <unsafe/serialize.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // Stands for a third-party type whose members are all private.
+    class quote
+    {
+        std::int64_t id = 0;
+        double bid = 0, ask = 0;
+        std::int32_t bid_size = 0, ask_size = 0;
+        char venue[4] = {};
+        bool firm = false;
+        std::int64_t time = 0;
+        std::int16_t flags = 0;
+
+    public:
+        quote() = default;
+        quote(std::int64_t i) : id(i), bid(i * 0.5), ask(i * 0.5 + 1), bid_size(int(i)), ask_size(int(i) + 1),
+                                venue{'X', 'N', 'Y', 'S'}, firm(i % 2), time(i * 1000), flags(std::int16_t(i)) {}
+
+        bool operator==(const quote& o) const
+        {
+            return id == o.id && bid == o.bid && ask == o.ask && bid_size == o.bid_size && ask_size == o.ask_size &&
+                std::memcmp(venue, o.venue, sizeof venue) == 0 && firm == o.firm && time == o.time && flags == o.flags;
+        }
+    };
+}
+
+UNSAFE_FIELDS(quote, id, bid, ask, bid_size, ask_size, venue, firm, time, flags)
+
+namespace
+{
+    // What serialization looks like when written field by field.
+    template<int i = 0>
+    char* serialize_fields(const quote& q, char* out)
+    {
+        if constexpr (i == unsafe::fields<quote>::count) return out;
+        else
+        {
+            const auto& f = unsafe::get<i>(q);
+            std::memcpy(out, &f, sizeof f);
+            return serialize_fields<i + 1>(q, out + sizeof f);
+        }
+    }
+
+    template<int i = 0>
+    const char* deserialize_fields(quote& q, const char* in)
+    {
+        if constexpr (i == unsafe::fields<quote>::count) return in;
+        else
+        {
+            auto& f = unsafe::get<i>(q);
+            std::memcpy(&f, in, sizeof f);
+            return deserialize_fields<i + 1>(q, in + sizeof f);
+        }
+    }
+}
+
+TEST_CASE("serialize")
+{
+    // id ... firm | padding | time, flags
+    constexpr auto runs = unsafe::field_runs<quote>();
+    static_assert(runs.second == 2);
+    static_assert(runs.first[0].offset == 0 && runs.first[0].size == 37);
+    static_assert(runs.first[1].offset == 40 && runs.first[1].size == 10);
+    static_assert(unsafe::serialized_size<quote>() == 47);
+
+    const quote q(7);
+    char a[unsafe::serialized_size<quote>()];
+    char b[unsafe::serialized_size<quote>()];
+    CHECK(unsafe::serialize(q, a) == a + sizeof a);
+    CHECK(serialize_fields(q, b) == b + sizeof b);
+    CHECK(std::memcmp(a, b, sizeof a) == 0);
+
+    quote r;
+    CHECK(unsafe::deserialize(r, a) == a + sizeof a);
+    CHECK(r == q);
+}
+
+TEST_CASE("serialize benchmark", "[.benchmark]")
+{
+    const std::size_t n = GENERATE(1000, 100000); // In cache and memory bound.
+    CAPTURE(n);
+    constexpr std::size_t size = unsafe::serialized_size<quote>();
+    std::vector<quote> quotes(n);
+    for (std::size_t i = 0; i < n; ++i) quotes[i] = quote(std::int64_t(i));
+    std::vector<char> buf(n * size);
+
+    BENCHMARK("per-field serialize")
+    {
+        char* out = buf.data();
+        for (const quote& q : quotes) out = serialize_fields(q, out);
+        return out;
+    };
+
+    BENCHMARK("unsafe::serialize")
+    {
+        char* out = buf.data();
+        for (const quote& q : quotes) out = unsafe::serialize(q, out);
+        return out;
+    };
+
+    BENCHMARK("per-field deserialize")
+    {
+        const char* in = buf.data();
+        for (quote& q : quotes) in = deserialize_fields(q, in);
+        return in;
+    };
+
+    BENCHMARK("unsafe::deserialize")
+    {
+        const char* in = buf.data();
+        for (quote& q : quotes) in = unsafe::deserialize(q, in);
+        return in;
+    };
+}
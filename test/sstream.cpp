@@ -0,0 +1,107 @@
+#include "catch.hpp"
+
+#include <unsafe/sstream.hpp>
+#include <unsafe/iostream.hpp>
+
+TEST_CASE("stringbuf release")
+{
+    std::ostringstream os;
+    for (int i = 0; i < 10000; ++i) os << i << ',';
+    const std::string expected = os.str();
+
+    auto [pbase, pptr, epptr] = unsafe::put_area(os.rdbuf());
+    std::string s = unsafe::release(*os.rdbuf());
+    CHECK(s == expected);
+    CHECK(s.c_str()[s.size()] == '\0');
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+    CHECK(s.data() == pbase);
+#endif
+
+    CHECK(os.str().empty());
+    os << "again";
+    CHECK(os.str() == "again");
+
+    // In and out, the get area reaching past the put position.
+    std::stringstream ss("hello world");
+    ss << "HELLO";
+    CHECK(unsafe::release(*ss.rdbuf()) == "HELLO world");
+    CHECK(ss.str().empty());
+
+    std::istringstream is("input only");
+    std::string word;
+    is >> word;
+    CHECK(unsafe::release(*is.rdbuf()) == "input only");
+}
+
+TEST_CASE("stringbuf adopt")
+{
+    std::string s(100000, 'a');
+    s += " tail";
+    const char* data = s.data();
+
+    std::istringstream is;
+    unsafe::adopt(*is.rdbuf(), std::move(s));
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+    auto [eback, gptr, egptr] = unsafe::get_area(is.rdbuf());
+    CHECK(eback == data);
+    CHECK(gptr == data);
+    CHECK(egptr == data + 100005);
+#endif
+    std::string head, tail;
+    CHECK(is >> head >> tail);
+    CHECK(head.size() == 100000);
+    CHECK(tail == "tail");
+
+    std::ostringstream os(std::ios_base::ate);
+    unsafe::adopt(*os.rdbuf(), std::string(100, 'x'));
+    os << 'y';
+    CHECK(os.str() == std::string(100, 'x') + 'y');
+
+    std::ostringstream trunc;
+    unsafe::adopt(*trunc.rdbuf(), std::string(100, 'x'));
+    trunc << 'y';
+    CHECK(trunc.str() == 'y' + std::string(99, 'x'));
+}
+
+TEST_CASE("stringbuf reserve")
+{
+    std::stringstream ss;
+    ss << "abc";
+    char c = 0;
+    ss >> c;
+
+    unsafe::reserve(*ss.rdbuf(), 1 << 20);
+    auto [pbase, pptr, epptr] = unsafe::put_area(ss.rdbuf());
+    CHECK(pptr - pbase == 3);
+#if (defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI) || defined(_LIBCPP_VERSION)
+    CHECK(epptr - pbase >= (1 << 20));
+#endif
+
+    for (int i = 0; i < 100000; ++i) ss << "0123456789";
+    CHECK(std::get<0>(unsafe::put_area(ss.rdbuf())) == pbase);
+
+    std::string rest;
+    CHECK(ss >> rest);
+    CHECK(rest.size() == 2 + 1000000);
+    CHECK(rest.substr(0, 4) == "bc01");
+}
+
+TEST_CASE("stringbuf release benchmark", "[.benchmark]")
+{
+    const std::string chunk(1 << 10, 'j');
+
+    BENCHMARK("ostringstream::str")
+    {
+        std::ostringstream os;
+        for (int i = 0; i < 4096; ++i) os << chunk;
+        return os.str().size();
+    };
+
+    BENCHMARK("unsafe::release")
+    {
+        std::ostringstream os;
+        unsafe::reserve(*os.rdbuf(), 4096 * chunk.size());
+        for (int i = 0; i < 4096; ++i) os << chunk;
+        return unsafe::release(*os.rdbuf()).size();
+    };
+}
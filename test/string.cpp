@@ -6,6 +6,8 @@
 #endif
 #include <unsafe/string.hpp>
 
+#include "counting_resource.hpp"
+
 #ifndef _LIBCPP_VERSION
 
 TEST_CASE("string")
@@ -70,4 +72,161 @@ TEST_CASE("pmr::string")
 }
 #endif
 
+TEST_CASE("string::resize_and_overwrite")
+{
+    const std::size_t n = GENERATE(8, 512);
+    CAPTURE(n);
+
+    std::string s = "abc";
+    unsafe::resize_and_overwrite(s, n, [](char* p, std::size_t n) {
+        CHECK((p[0] == 'a' && p[1] == 'b' && p[2] == 'c'));
+        std::memset(p + 3, 'x', n - 3);
+        return n - 1;
+    });
+    CHECK(s.size() == n - 1);
+    CHECK(s.capacity() >= n);
+    CHECK(s.compare(0, 3, "abc") == 0);
+    CHECK(s.find_first_not_of('x', 3) == std::string::npos);
+    CHECK(s.c_str()[n - 1] == '\0');
+
+    unsafe::resize_and_overwrite(s, 2, [](char*, std::size_t) { return 1; });
+    CHECK(s == "a");
+    CHECK(s.c_str()[1] == '\0');
+}
+
+#ifdef __cpp_lib_memory_resource
+TEST_CASE("pmr::string::resize_and_overwrite")
+{
+    const std::size_t n = GENERATE(8, 512);
+    CAPTURE(n);
+
+    alignas(std::max_align_t) char buf[1024];
+    std::pmr::monotonic_buffer_resource mr(buf, sizeof(buf), std::pmr::null_memory_resource());
+    std::pmr::string s("abc", &mr);
+
+    unsafe::resize_and_overwrite(s, n, [](char* p, std::size_t n) {
+        std::memset(p + 3, 'y', n - 3);
+        return n;
+    });
+    CHECK(s.size() == n);
+    CHECK(s.compare(0, 3, "abc") == 0);
+    CHECK(s.find_first_not_of('y', 3) == std::string::npos);
+    CHECK(s.c_str()[n] == '\0');
+    CHECK(s.get_allocator().resource() == &mr);
+    if (n > 15) CHECK((s.data() >= buf && s.data() + n < buf + sizeof(buf)));
+}
+#endif
+
+TEST_CASE("string::release")
+{
+    const std::size_t n = GENERATE(3, 100);
+    CAPTURE(n);
+
+    std::string s(n, 'x');
+    auto [p, size, capacity] = unsafe::release(s);
+    CHECK(size == n);
+    CHECK(capacity >= n);
+    CHECK(p[n] == '\0');
+    CHECK(s.empty());
+    CHECK(s.c_str()[0] == '\0');
+
+    std::string t(50, 'y');
+    unsafe::adopt(t, p, size, capacity);
+    CHECK(t == std::string(n, 'x'));
+    CHECK(t.c_str()[n] == '\0');
+    if (capacity > 15) CHECK(t.data() == p);
+    t.append(100, 'z');
+    CHECK(t.size() == n + 100);
+}
+
+#ifdef __cpp_lib_memory_resource
+TEST_CASE("pmr::string::release")
+{
+    counting_resource mr;
+
+    {
+        std::pmr::string s(100, 'x', &mr);
+        auto [p, size, capacity] = unsafe::release(s);
+        CHECK(mr.outstanding() == 1);
+
+        std::pmr::string t(200, 'y', &mr);
+        unsafe::adopt(t, p, size, capacity);
+        CHECK(mr.outstanding() == 1);
+        CHECK(t == std::pmr::string(100, 'x'));
+    }
+
+    CHECK(mr.outstanding() == 0);
+    CHECK(mr.mismatches == 0);
+
+    {
+        std::pmr::string s("abc", &mr);
+        auto [p, size, capacity] = unsafe::release(s);
+        CHECK(mr.outstanding() == 1);
+        CHECK(std::string(p) == "abc");
+
+        std::pmr::string t(&mr);
+        unsafe::adopt(t, p, size, capacity);
+        CHECK(mr.outstanding() == 0);
+        CHECK(t == "abc");
+    }
+
+    CHECK(mr.outstanding() == 0);
+    CHECK(mr.mismatches == 0);
+}
+#endif
+
+TEST_CASE("borrowed_string")
+{
+    const auto length = [](const std::string& s) {
+        CHECK(s.c_str()[s.size()] == '\0');
+        return s.size();
+    };
+
+    // Longer than SSO, which MSVC always copies into.
+    const char text[] = "hello, this is an unsafe world";
+
+    {
+        unsafe::borrowed_string<const char> bs(text);
+        static_assert(std::is_same_v<decltype(bs.get()), const std::string&>);
+        const std::string& s = bs;
+        CHECK(s.data() == text);
+        CHECK(length(bs) == sizeof(text) - 1);
+    }
+
+    {
+        unsafe::borrowed_string<const char> bs(text + 7, 23);
+        const std::string& s = bs;
+        CHECK(s.data() == text + 7);
+        CHECK(s == "this is an unsafe world");
+    }
+
+    {
+        unsafe::borrowed_string<const char> bs(text + 7, 17);
+        const std::string& s = bs;
+        CHECK(s.data() != text + 7);
+        CHECK(s == "this is an unsafe");
+        CHECK(length(bs) == 17);
+    }
+
+    char buf[] = "hello, this is an unsafe world";
+    {
+        unsafe::borrowed_string<char> bs(buf + 7, 17, sizeof(buf) - 7);
+        static_assert(std::is_same_v<decltype(bs.get()), std::string&>);
+        const std::string& s = bs;
+        CHECK(s.data() == buf + 7);
+        CHECK(s == "this is an unsafe");
+        CHECK(length(bs) == 17);
+        CHECK(buf[24] == '\0');
+    }
+    CHECK(buf[24] == ' ');
+
+    {
+        unsafe::borrowed_string<char> bs(buf, 5, 5);
+        const std::string& s = bs;
+        CHECK(s.data() != buf);
+        CHECK(s == "hello");
+    }
+    CHECK(std::string(buf) == text);
+}
+
 #endif
@@ -0,0 +1,145 @@
+#include "catch.hpp"
+
+#include <version>
+#ifdef __cpp_lib_memory_resource
+#include <memory_resource>
+#endif
+#include <unsafe/transfer.hpp>
+
+#include "counting_resource.hpp"
+
+#ifndef _LIBCPP_VERSION
+
+TEST_CASE("transfer")
+{
+    SECTION("vector to string")
+    {
+        std::vector<char> v(100, 'x');
+        v.reserve(128);
+        const char* data = v.data();
+
+        std::string s(64, 'y');
+        unsafe::transfer(v, s);
+
+        CHECK(s.data() == data);
+        CHECK(s.size() == 100);
+        CHECK(s.capacity() == 127);
+        CHECK(s == std::string(100, 'x'));
+        CHECK(s.c_str()[100] == '\0');
+        CHECK(v.empty());
+        CHECK(v.capacity() == 0);
+
+        s += "z";
+        CHECK(s.data() == data);
+    }
+
+    SECTION("string to vector")
+    {
+        std::string s(100, 'x');
+        const char* data = s.data();
+        const std::size_t capacity = s.capacity();
+
+        std::vector<char> v(64, 'y');
+        unsafe::transfer(s, v);
+
+        CHECK(v.data() == data);
+        CHECK(v.size() == 100);
+        CHECK(v.capacity() == capacity + 1);
+        CHECK(std::string(v.begin(), v.end()) == std::string(100, 'x'));
+        CHECK(s.empty());
+        CHECK(s.c_str()[0] == '\0');
+
+        s = "reusable";
+        CHECK(s == "reusable");
+    }
+
+    SECTION("round trip")
+    {
+        std::vector<char> v(1000, 'x');
+        v.push_back('y');
+        const char* data = v.data();
+
+        std::string s;
+        unsafe::transfer(v, s);
+        unsafe::transfer(s, v);
+        CHECK(v.data() == data);
+        CHECK(v.size() == 1001);
+        CHECK(v.back() == 'y');
+    }
+
+    SECTION("copy into SSO")
+    {
+        std::vector<char> v{'a', 'b', 'c'};
+        v.reserve(64);
+
+        std::string s;
+        unsafe::transfer(v, s);
+        CHECK(s == "abc");
+        CHECK(v.empty());
+
+        std::vector<char> w;
+        unsafe::transfer(s, w);
+        CHECK(std::string(w.begin(), w.end()) == "abc");
+        CHECK(s.empty());
+    }
+
+    SECTION("copy without room for terminator")
+    {
+        std::vector<char> v(100, 'x');
+        v.shrink_to_fit();
+        REQUIRE(v.size() == v.capacity());
+        const char* data = v.data();
+
+        std::string s;
+        unsafe::transfer(v, s);
+        CHECK(s.data() != data);
+        CHECK(s == std::string(100, 'x'));
+        CHECK(v.empty());
+    }
+}
+
+#ifdef __cpp_lib_memory_resource
+TEST_CASE("pmr::transfer")
+{
+    counting_resource mr;
+
+    {
+        std::pmr::vector<char> v(100, 'x', &mr);
+        v.reserve(128);
+        const char* data = v.data();
+
+        std::pmr::string s(200, 'y', &mr);
+        unsafe::transfer(v, s);
+        CHECK(s.data() == data);
+        CHECK(s == std::pmr::string(100, 'x'));
+        CHECK(mr.outstanding() == 1);
+
+        unsafe::transfer(s, v);
+        CHECK(v.data() == data);
+        CHECK(v.size() == 100);
+        CHECK(mr.outstanding() == 1);
+    }
+
+    CHECK(mr.outstanding() == 0);
+    CHECK(mr.mismatches == 0);
+
+    {
+        counting_resource other;
+        std::pmr::vector<char> v(100, 'x', &mr);
+        v.reserve(128);
+        const char* data = v.data();
+
+        std::pmr::string s(&other);
+        unsafe::transfer(v, s);
+        CHECK(s.data() != data);
+        CHECK(s == std::pmr::string(100, 'x'));
+        CHECK(s.get_allocator().resource() == &other);
+        CHECK(v.empty());
+    }
+
+    CHECK(mr.outstanding() == 0);
+    CHECK(mr.mismatches == 0);
+}
+#endif
+
+#endif
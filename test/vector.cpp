@@ -6,6 +6,13 @@
 #endif
 #include <unsafe/vector.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "counting_resource.hpp"
+
 TEST_CASE("vector")
 {
     {
@@ -57,3 +64,243 @@ TEST_CASE("pmr::vector")
     }
 }
 #endif
+
+TEST_CASE("vector::resize_uninitialized")
+{
+    std::vector<int> v{1, 2, 3};
+
+    int* p = unsafe::resize_uninitialized(v, 1000);
+    CHECK(p == v.data());
+    CHECK(v.size() == 1000);
+    CHECK(v.capacity() >= 1000);
+    CHECK((v[0] == 1 && v[1] == 2 && v[2] == 3));
+
+    p = unsafe::append_uninitialized(v, 24);
+    CHECK(p == v.data() + 1000);
+    CHECK(v.size() == 1024);
+    std::fill_n(p, 24, 42);
+    CHECK(v.back() == 42);
+
+    const int* data = v.data();
+    CHECK(unsafe::resize_uninitialized(v, 3) == data);
+    CHECK(v.size() == 3);
+    CHECK(v.capacity() >= 1024);
+    CHECK((v[0] == 1 && v[1] == 2 && v[2] == 3));
+
+    for (int i = 0; i < 100; ++i)
+        *unsafe::append_uninitialized(v, 1) = i;
+    CHECK(v.size() == 103);
+    CHECK(v.back() == 99);
+}
+
+#ifdef __cpp_lib_memory_resource
+TEST_CASE("pmr::vector::resize_uninitialized")
+{
+    alignas(int) unsigned char buf[4096];
+    std::pmr::monotonic_buffer_resource mr(buf, sizeof(buf), std::pmr::null_memory_resource());
+    std::pmr::vector<int> v(&mr);
+
+    int* p = unsafe::resize_uninitialized(v, 100);
+    CHECK((p >= (int*)buf && p + 100 <= (int*)(buf + sizeof(buf))));
+    CHECK(v.size() == 100);
+    CHECK(v.get_allocator().resource() == &mr);
+    CHECK_THROWS_AS(unsafe::append_uninitialized(v, 4096), std::bad_alloc);
+    CHECK(v.size() == 100);
+}
+#endif
+
+TEST_CASE("vector::resize_uninitialized benchmark", "[.benchmark]")
+{
+    const std::size_t n = GENERATE(std::size_t(4) << 10, std::size_t(1) << 20, std::size_t(16) << 20);
+    CAPTURE(n);
+
+    std::vector<std::uint8_t> v;
+    v.reserve(n);
+
+    BENCHMARK("std::vector::resize")
+    {
+        v.clear();
+        v.resize(n);
+        return v.data();
+    };
+
+    BENCHMARK("unsafe::resize_uninitialized")
+    {
+        v.clear();
+        return unsafe::resize_uninitialized(v, n);
+    };
+}
+
+TEST_CASE("vector::release")
+{
+    std::vector<int> v{1, 2, 3};
+    v.reserve(16);
+    const int* data = v.data();
+
+    auto [p, size, capacity] = unsafe::release(v);
+    CHECK(p == data);
+    CHECK(size == 3);
+    CHECK(capacity == 16);
+    CHECK(v.empty());
+    CHECK(v.capacity() == 0);
+
+    std::vector<int> w{4, 5};
+    unsafe::adopt(w, p, size, capacity);
+    CHECK(w.data() == data);
+    CHECK(w == std::vector<int>{1, 2, 3});
+    CHECK(w.capacity() == 16);
+}
+
+#ifdef __cpp_lib_memory_resource
+TEST_CASE("pmr::vector::release")
+{
+    counting_resource mr;
+
+    {
+        std::pmr::vector<int> v({1, 2, 3}, &mr);
+        auto [p, size, capacity] = unsafe::release(v);
+        CHECK(mr.outstanding() == 1);
+
+        std::pmr::vector<int> w({4, 5, 6, 7}, &mr);
+        unsafe::adopt(w, p, size, capacity);
+        CHECK(mr.outstanding() == 1);
+        CHECK(w == std::pmr::vector<int>{1, 2, 3});
+
+        w.push_back(4);
+        CHECK(w.size() == 4);
+    }
+
+    CHECK(mr.outstanding() == 0);
+    CHECK(mr.mismatches == 0);
+
+    {
+        std::pmr::vector<int> v(&mr);
+        std::pmr::polymorphic_allocator<int> a(&mr);
+        int* p = a.allocate(8);
+        p[0] = 42;
+        unsafe::adopt(v, p, 1, 8);
+        CHECK(v.capacity() == 8);
+        CHECK(v.front() == 42);
+    }
+
+    CHECK(mr.outstanding() == 0);
+    CHECK(mr.mismatches == 0);
+}
+#endif
+
+TEST_CASE("borrowed_vector")
+{
+    const auto sum = [](const std::vector<int>& v) {
+        int s = 0;
+        for (int x : v) s += x;
+        return s;
+    };
+
+    const int arr[] = {1, 2, 3, 4, 5};
+    {
+        unsafe::borrowed_vector<const int> bv(arr + 1, 3);
+        static_assert(std::is_same_v<decltype(bv.get()), const std::vector<int>&>);
+        const std::vector<int>& v = bv;
+        CHECK(v.data() == arr + 1);
+        CHECK(v.size() == 3);
+        CHECK(sum(bv) == 9);
+    }
+
+    int buf[] = {1, 2, 3};
+    {
+        unsafe::borrowed_vector<int> bv(buf, 3);
+        std::vector<int>& v = bv;
+        std::sort(v.begin(), v.end(), std::greater<>());
+    }
+    CHECK((buf[0] == 3 && buf[1] == 2 && buf[2] == 1));
+}
+
+TEMPLATE_TEST_CASE("vector::reserve", "", std::allocator<std::uint64_t>, unsafe::malloc_allocator<std::uint64_t>)
+{
+    std::vector<std::uint64_t, TestType> v;
+    for (std::uint64_t i = 0; i < 100000; ++i)
+    {
+        if (v.size() == v.capacity()) unsafe::reserve(v, 2 * v.size() + 1);
+        v.push_back(i);
+    }
+
+    CHECK(v.size() == 100000);
+    CHECK(v.capacity() >= 100000);
+    bool ok = true;
+    for (std::uint64_t i = 0; i < v.size(); ++i) ok = ok && v[i] == i;
+    CHECK(ok);
+
+    const std::size_t capacity = v.capacity();
+    unsafe::reserve(v, 10);
+    CHECK(v.capacity() == capacity);
+
+    v.shrink_to_fit();
+    unsafe::reserve(v, capacity * 4);
+    CHECK(v.capacity() == capacity * 4);
+    CHECK(v.back() == 99999);
+
+    std::vector<std::string> s(3, "x");
+    unsafe::reserve(s, 100);
+    CHECK(s.capacity() >= 100);
+    CHECK(s[2] == "x");
+}
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <iostream>
+
+namespace
+{
+    // Runs f in a child process and returns its peak resident set size in KiB.
+    template<class F>
+    long peak_rss(F f)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            f();
+            _exit(0);
+        }
+
+        int status = 0;
+        struct rusage ru = {};
+        wait4(pid, &status, 0, &ru);
+        return ru.ru_maxrss;
+    }
+}
+
+TEST_CASE("vector::reserve benchmark", "[.benchmark]")
+{
+    const std::size_t n = std::size_t(16) << 20;
+
+    const auto push_back = [n] {
+        std::vector<std::uint64_t> v;
+        for (std::size_t i = 0; i < n; ++i) v.push_back(i);
+        return v.size();
+    };
+
+    const auto append = [n] {
+        std::vector<std::uint64_t> v;
+        for (std::size_t i = 0; i < n; ++i) *unsafe::append_uninitialized(v, 1) = i;
+        return v.size();
+    };
+
+    const auto append_realloc = [n] {
+        std::vector<std::uint64_t, unsafe::malloc_allocator<std::uint64_t>> v;
+        for (std::size_t i = 0; i < n; ++i) *unsafe::append_uninitialized(v, 1) = i;
+        return v.size();
+    };
+
+    const long base = peak_rss([] {});
+    std::cout << "peak RSS of " << (n * sizeof(std::uint64_t) >> 20) << " MiB vector (KiB):\n"
+              << "  std::vector::push_back        " << peak_rss(push_back) - base << '\n'
+              << "  unsafe::append_uninitialized  " << peak_rss(append) - base << '\n'
+              << "    with malloc_allocator       " << peak_rss(append_realloc) - base << '\n';
+
+    BENCHMARK("std::vector::push_back") { return push_back(); };
+    BENCHMARK("unsafe::append_uninitialized") { return append(); };
+    BENCHMARK("unsafe::append_uninitialized with malloc_allocator") { return append_realloc(); };
+}
+#endif